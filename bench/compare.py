@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""Vergleicht zwei Ergebnisse von simbench (JSON) und meldet Verschlechterungen.
+
+Aufruf: compare.py baseline.json result.json [Toleranz in Prozent, Vorgabe 5]
+Rückgabe 1, wenn ein Wert um mehr als die Toleranz gestiegen ist.
+"""
+import json
+import sys
+
+
+def flatten(data, prefix=""):
+    """Verschachtelte Werte zu "gruppe.wert" abflachen."""
+    out = {}
+    for key, value in data.items():
+        name = prefix + key
+        if isinstance(value, dict):
+            out.update(flatten(value, name + "."))
+        else:
+            out[name] = value
+    return out
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    with open(sys.argv[1]) as f:
+        base = flatten(json.load(f))
+    with open(sys.argv[2]) as f:
+        new = flatten(json.load(f))
+    tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 5.0
+
+    worse = 0
+    for name in sorted(new):
+        if name not in base or name.endswith("count") or name == "cycles":
+            continue
+        old, cur = base[name], new[name]
+        delta = (cur - old) * 100.0 / old if old else 0.0
+        flag = ""
+        if delta > tolerance:
+            flag = "  <-- schlechter"
+            worse += 1
+        print("%-36s %12.2f %12.2f %+7.1f%%%s" % (name, old, cur, delta, flag))
+    return 1 if worse else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
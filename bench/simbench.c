@@ -0,0 +1,565 @@
+/*
+Titel     : Benchmark der Firmware unter simavr
+--------------------------------------------------------------------------------------
+Funktion  : Lädt die mit -DBENCH übersetzte Firmware (Umgebung "bench") in einen
+            simulierten ATmega328P mit 16MHz, spielt die Eingangssignale aus einer
+            Skriptdatei ein und bildet PCF8574-Display (0x27) und DS18B20 an D9 nach.
+            Gemessen wird taktgenau:
+              - Dauer von loop() (Messmarken MARK_LOOP/MARK_LOOP_END in GPIOR0)
+              - Kosten von ISR(TIMER2_COMPA_vect) (Zeitrad) vom Sprung in den Vektor bis reti
+              - Zeit mit gesperrten Interrupts, getrennt nach OneWire-Bitslots
+                (DDRB1 wechselt im gesperrten Abschnitt), ISRs und Rest
+              - I²C-Bytes je Displaybild (Messmarke MARK_FRAME)
+              - Zeit vom Reset bis zur ersten Relaisentscheidung (Messmarke MARK_DECIDE)
+              - Anteil der Takte außerhalb des Schlafmodus (hal_Sleep)
+            Ergebnis als JSON auf stdout, eine Zeile.
+            Aufruf: simbench firmware.elf stimuli.txt
+            Stand: noch nicht gegen simavr übersetzt und ausgeführt.
+--------------------------------------------------------------------------------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_twi.h>
+
+#include "../include/bench.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define F_CPU 16000000UL
+#define GPIOR0_ADDR 0x3E                                //Datenadresse von GPIOR0
+#define VECT_TICK (7*4)                                 //Byteadresse TIMER2_COMPA_vect
+#define VECT_END (26*4)                                 //Ende der Vektortabelle
+#define LCD_ADDR 0x27                                   //I²C-Adresse des PCF8574
+#define OW_PIN 1                                        //DS18B20 an D9 = PB1
+#define US(c) ((double)(c)*1e6/F_CPU)                   //Takte in µs
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct                                          //Anzahl/Summe/Maximum einer Messgröße
+{
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+} Stat;
+
+typedef struct                                          //eine Zeile des Stimuli-Skripts
+{
+  uint32_t ms;
+  char port;
+  int8_t bit;                                           //-1 = Temperatur, -2 = Ende
+  double value;
+} Stimulus;
+
+//------------------------------------- Variablen -------------------------------------
+static avr_t *Avr;
+static Stimulus Script[256];
+static int ScriptLen;
+
+static Stat Loop;                                       //loop() von Marke zu Marke in Takten
+static Stat LoopPeriod;                                 //Abstand zweier loop()-Aufrufe
+static Stat Isr;                                        //ISR(TIMER2_COMPA_vect) in Takten
+static Stat CliOneWire;                                 //gesperrt während OneWire-Bitslots
+static Stat CliIsr;                                     //gesperrt in Interruptroutinen
+static Stat CliOther;                                   //übrige gesperrte Abschnitte
+static Stat Frame;                                      //I²C-Bytes je Displaybild
+static avr_cycle_count_t Decide;                        //Takte vom Reset bis MARK_DECIDE
+static avr_cycle_count_t Asleep;                        //Takte in cpu_Sleeping
+static avr_cycle_count_t LoopStart;
+static avr_cycle_count_t LoopLast;
+static uint32_t I2cBytes;                               //seit der letzten Bildmarke
+static uint32_t I2cTotal;
+
+//------------------------------------- Functions -------------------------------------
+static void stat_Add(Stat *s, uint64_t v)
+{
+  s->count++;
+  s->sum+=v;
+  if(v>s->max)
+    s->max=v;
+}
+
+//-------------------------------------------------------------------------------------------
+static void print_Stat(const char *name, const Stat *s, int last)
+{
+  printf("\"%s\":{\"count\":%llu,\"mean_us\":%.2f,\"max_us\":%.2f,\"total_us\":%.0f}%s",
+         name, (unsigned long long)s->count,
+         s->count ? US(s->sum)/s->count : 0.0, US(s->max), US(s->sum), last ? "" : ",");
+}
+
+//------------------------------------ Messmarken -------------------------------------
+static void mark_Write(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+  (void)param;
+  avr->data[addr]=v;
+  switch(v)
+  {
+    case MARK_LOOP:
+      if(LoopLast)
+        stat_Add(&LoopPeriod, avr->cycle-LoopLast);
+      LoopStart=LoopLast=avr->cycle;
+      break;
+    case MARK_LOOP_END:
+      if(LoopStart)
+        stat_Add(&Loop, avr->cycle-LoopStart);
+      break;
+    case MARK_FRAME:
+      stat_Add(&Frame, I2cBytes);
+      I2cBytes=0;
+      break;
+    case MARK_DECIDE:
+      if(!Decide)
+        Decide=avr->cycle;
+      break;
+  }
+}
+
+//------------------------------------ PCF8574/LCD ------------------------------------
+static avr_irq_t *TwiIrq;                               //eigene IRQs: Eingang und Ausgang des Busses
+static int LcdSelected;
+
+static void twi_Hook(avr_irq_t *irq, uint32_t value, void *param)
+{
+  (void)irq;
+  (void)param;
+  avr_twi_msg_irq_t v;
+  v.u.v=value;
+  if(v.u.twi.msg & TWI_COND_STOP)
+    LcdSelected=0;
+  if(v.u.twi.msg & TWI_COND_START)                      //Adressbyte: nur 0x27 quittieren
+  {
+    LcdSelected=(v.u.twi.addr>>1)==LCD_ADDR;
+    if(LcdSelected)
+      avr_raise_irq(TwiIrq+TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, v.u.twi.addr, 1));
+  }
+  if(LcdSelected && (v.u.twi.msg & TWI_COND_WRITE))     //Datenbyte an den Portexpander
+  {
+    avr_raise_irq(TwiIrq+TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, v.u.twi.addr, 1));
+    I2cBytes++;
+    I2cTotal++;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void twi_Init(void)
+{
+  static const char *names[2]={ "8>lcd.out", "32<lcd.in" };
+  TwiIrq=avr_alloc_irq(&Avr->irq_pool, 0, 2, names);
+  avr_irq_register_notify(TwiIrq+TWI_IRQ_OUTPUT, twi_Hook, NULL);
+  avr_connect_irq(TwiIrq+TWI_IRQ_INPUT, avr_io_getirq(Avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+  avr_connect_irq(avr_io_getirq(Avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), TwiIrq+TWI_IRQ_OUTPUT);
+}
+
+//-------------------------------------- DS18B20 --------------------------------------
+enum { OW_IDLE, OW_ROM, OW_SEARCH, OW_MATCH, OW_FUNC, OW_SEND, OW_RECV, OW_CONVERT };
+
+static uint8_t Rom[8]={ 0x28, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x00 };   //CRC in ow_Init()
+static uint8_t Scratch[9]={ 0, 0, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0 };
+static double Temp=20.0;
+static avr_irq_t *OwPin;                                //Eingang PB1 des Controllers
+static uint8_t Ddr, Port;                               //Zustand DDRB/PORTB aus den IRQs
+static int MasterLow;                                   //Controller zieht den Bus auf L
+static int SlaveLow;                                    //Sensor zieht den Bus auf L
+static avr_cycle_count_t Fall;                          //Beginn des aktuellen Slots
+static int OwState=OW_IDLE;
+static uint8_t OwBuf[9];                                //Sende-/Empfangspuffer
+static int OwBits, OwPos;                               //Bitanzahl und -position
+static int SearchPhase;                                 //Suche: Bit, Komplement, Richtung
+static avr_cycle_count_t ConvertEnd;
+static int DdrToggled;                                  //DDRB1 im gesperrten Abschnitt gewechselt
+
+static uint8_t crc8(const uint8_t *p, int len)          //Dallas/Maxim CRC, Polynom 0x8C
+{
+  uint8_t crc=0;
+  while(len--)
+  {
+    uint8_t b=*p++;
+    for(int i=0; i<8; i++, b>>=1)
+      crc=((crc^b)&1) ? (crc>>1)^0x8C : crc>>1;
+  }
+  return crc;
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Drive(int low)                           //Pegel für den Controller nachführen,
+{                                                       //Pullup liefert H, wenn keiner zieht
+  SlaveLow=low;
+  avr_raise_irq(OwPin, (MasterLow || SlaveLow) ? 0 : 1);
+}
+
+//-------------------------------------------------------------------------------------------
+static avr_cycle_count_t ow_Release(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  (void)avr;
+  (void)when;
+  (void)param;
+  ow_Drive(0);
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+static avr_cycle_count_t ow_Presence(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  (void)when;
+  (void)param;
+  ow_Drive(1);                                          //Präsenzimpuls 120µs
+  avr_cycle_timer_register_usec(avr, 120, ow_Release, NULL);
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Send(const uint8_t *data, int bytes)
+{
+  memcpy(OwBuf, data, bytes);
+  OwBits=bytes*8;
+  OwPos=0;
+  OwState=OW_SEND;
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Recv(int bytes, int state)
+{
+  memset(OwBuf, 0, sizeof(OwBuf));
+  OwBits=bytes*8;
+  OwPos=0;
+  OwState=state;
+}
+
+//-------------------------------------------------------------------------------------------
+static int ow_TxBit(void)                               //nächstes Bit, das der Sensor sendet
+{
+  int bit;
+  switch(OwState)
+  {
+    case OW_SEND:
+      bit=(OwBuf[OwPos/8]>>(OwPos%8))&1;
+      if(++OwPos==OwBits)
+        OwState=OW_IDLE;
+      return bit;
+    case OW_SEARCH:
+      bit=(Rom[OwPos/8]>>(OwPos%8))&1;
+      return SearchPhase==0 ? bit : !bit;
+    case OW_CONVERT:                                    //Lesezeitschlitz: 1 = Wandlung fertig
+      return Avr->cycle>=ConvertEnd;
+    default:
+      return 1;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Command(uint8_t cmd)                     //Funktionsbefehl nach ROM-Befehl
+{
+  int16_t raw;
+  switch(cmd)
+  {
+    case 0x44:                                          //Convert T
+      ConvertEnd=Avr->cycle+avr_usec_to_cycles(Avr, 750000);
+      OwState=OW_CONVERT;
+      raw=(int16_t)(Temp*16);
+      Scratch[0]=raw&0xFF;
+      Scratch[1]=raw>>8;
+      Scratch[8]=crc8(Scratch, 8);
+      break;
+    case 0xBE:                                          //Read Scratchpad
+      Scratch[8]=crc8(Scratch, 8);
+      ow_Send(Scratch, 9);
+      break;
+    case 0xB4:                                          //Read Power Supply: extern versorgt
+      OwState=OW_CONVERT;
+      ConvertEnd=0;
+      break;
+    case 0x4E:                                          //Write Scratchpad: TH, TL, Konfiguration
+      ow_Recv(3, OW_RECV);
+      break;
+    default:
+      OwState=OW_IDLE;
+      break;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_RxBit(int bit)                           //vom Controller geschriebenes Bit
+{
+  switch(OwState)
+  {
+    case OW_ROM:
+    case OW_FUNC:
+    case OW_MATCH:
+    case OW_RECV:
+      if(bit)
+        OwBuf[OwPos/8]|=1<<(OwPos%8);
+      if(++OwPos<OwBits)
+        return;
+      if(OwState==OW_ROM)
+      {
+        switch(OwBuf[0])
+        {
+          case 0xF0: OwPos=0; SearchPhase=0; OwState=OW_SEARCH; break;
+          case 0x55: ow_Recv(8, OW_MATCH); break;
+          case 0xCC: ow_Recv(1, OW_FUNC); break;
+          case 0x33: ow_Send(Rom, 8); break;
+          default:   OwState=OW_IDLE; break;
+        }
+      }
+      else if(OwState==OW_MATCH)
+      {
+        if(memcmp(OwBuf, Rom, 8)==0)
+          ow_Recv(1, OW_FUNC);
+        else
+          OwState=OW_IDLE;
+      }
+      else if(OwState==OW_FUNC)
+      {
+        ow_Command(OwBuf[0]);
+      }
+      else                                              //Scratchpad beschrieben
+      {
+        memcpy(&Scratch[2], OwBuf, 3);
+        OwState=OW_IDLE;
+      }
+      break;
+    case OW_SEARCH:                                     //Richtungsbit des Controllers
+      if(bit!=((Rom[OwPos/8]>>(OwPos%8))&1))
+      {
+        OwState=OW_IDLE;                                //anderer Zweig, Sensor schweigt
+        return;
+      }
+      SearchPhase=0;
+      if(++OwPos==64)
+        ow_Recv(1, OW_FUNC);
+      break;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static int ow_Reading(void)                             //erwartet der Sensor einen Lesezeitschlitz?
+{
+  return OwState==OW_SEND || OwState==OW_CONVERT || (OwState==OW_SEARCH && SearchPhase<2);
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Bus(void)                                //Flanken des Controllers auswerten
+{
+  int low=(Ddr & (1<<OW_PIN)) && !(Port & (1<<OW_PIN));
+  if(low==MasterLow)
+  {
+    ow_Drive(SlaveLow);                                 //Portschreiben überschreibt den Eingang
+    return;
+  }
+  MasterLow=low;
+  if(low)                                               //fallende Flanke: Slot beginnt
+  {
+    Fall=Avr->cycle;
+    if(ow_Reading())
+    {
+      int bit=ow_TxBit();
+      if(OwState==OW_SEARCH)
+        SearchPhase++;
+      if(!bit)                                          //0 senden: Bus 30µs halten
+      {
+        ow_Drive(1);
+        avr_cycle_timer_register_usec(Avr, 30, ow_Release, NULL);
+        return;
+      }
+    }
+  }
+  else                                                  //steigende Flanke: Slot auswerten
+  {
+    double us=US(Avr->cycle-Fall);
+    if(us>=400)                                         //Reset
+    {
+      ow_Recv(1, OW_ROM);
+      avr_cycle_timer_register_usec(Avr, 30, ow_Presence, NULL);
+    }
+    else if(!ow_Reading() && OwState!=OW_IDLE)
+    {
+      ow_RxBit(us<30);                                  //kurz = 1, lang = 0
+    }
+  }
+  ow_Drive(SlaveLow);
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Ddr(avr_irq_t *irq, uint32_t value, void *param)
+{
+  (void)irq;
+  (void)param;
+  if((Ddr^value) & (1<<OW_PIN))
+    DdrToggled=1;
+  Ddr=value;
+  ow_Bus();
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Port(avr_irq_t *irq, uint32_t value, void *param)
+{
+  (void)irq;
+  (void)param;
+  Port=value;
+  ow_Bus();
+}
+
+//-------------------------------------------------------------------------------------------
+static void ow_Init(void)
+{
+  OwPin=avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('B'), OW_PIN);
+  avr_irq_register_notify(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('B'), IOPORT_IRQ_DIRECTION_ALL),
+                          ow_Ddr, NULL);
+  avr_irq_register_notify(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('B'), IOPORT_IRQ_REG_PORT),
+                          ow_Port, NULL);
+  Rom[7]=crc8(Rom, 7);
+  ow_Drive(0);
+}
+
+//------------------------------------- Stimuli ---------------------------------------
+static int load_Script(const char *name)                //Zeilen: <ms> <Signal> <Wert>
+{
+  static const struct { const char *name; char port; int8_t bit; } pins[]=
+  {
+    { "LV0", 'D', 7 }, { "LV1", 'D', 6 }, { "LV2", 'D', 4 }, { "LV3", 'D', 5 },
+    { "LV4", 'D', 3 }, { "SKIM", 'D', 2 }, { "ON", 'B', 2 }, { "OFF", 'B', 3 },
+    { "temp", 0, -1 }, { "end", 0, -2 },
+  };
+  FILE *f=fopen(name, "r");
+  if(!f)
+    return 0;
+  char line[80], sig[16];
+  unsigned ms;
+  double value;
+  while(ScriptLen<(int)(sizeof(Script)/sizeof(Script[0])) && fgets(line, sizeof(line), f))
+  {
+    value=0;
+    if(line[0]=='#' || sscanf(line, "%u %15s %lf", &ms, sig, &value)<2)
+      continue;
+    for(unsigned i=0; i<sizeof(pins)/sizeof(pins[0]); i++)
+    {
+      if(strcmp(sig, pins[i].name)==0)
+      {
+        Stimulus *s=&Script[ScriptLen++];
+        s->ms=ms;
+        s->port=pins[i].port;
+        s->bit=pins[i].bit;
+        s->value=(pins[i].port=='B') ? !value : value; //Taster L-aktiv
+      }
+    }
+  }
+  fclose(f);
+  return ScriptLen;
+}
+
+//-------------------------------------------------------------------------------------------
+static void set_Pin(char port, int bit, int level)
+{
+  avr_raise_irq(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ(port), bit), level);
+}
+
+//-------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  elf_firmware_t fw;
+  if(argc<3)
+  {
+    fprintf(stderr, "Aufruf: %s firmware.elf stimuli.txt\n", argv[0]);
+    return 1;
+  }
+  memset(&fw, 0, sizeof(fw));
+  if(elf_read_firmware(argv[1], &fw))
+  {
+    fprintf(stderr, "%s nicht lesbar\n", argv[1]);
+    return 1;
+  }
+  if(!load_Script(argv[2]))
+  {
+    fprintf(stderr, "%s nicht lesbar oder leer\n", argv[2]);
+    return 1;
+  }
+  Avr=avr_make_mcu_by_name("atmega328p");
+  avr_init(Avr);
+  fw.frequency=F_CPU;
+  avr_load_firmware(Avr, &fw);
+
+  avr_register_io_write(Avr, GPIOR0_ADDR, mark_Write, NULL);
+  twi_Init();
+  ow_Init();
+  set_Pin('B', 2, 1);                                   //Taster offen (Pullup)
+  set_Pin('B', 3, 1);
+
+  int next=0;
+  int state=cpu_Running;
+  int sei=0;                                            //I-Flag im letzten Schritt
+  int inVector=0;                                       //Vektorsprung im gesperrten Abschnitt
+  avr_cycle_count_t cliStart=0, isrStart=0;
+  uint32_t endMs=0xFFFFFFFF;
+  while(state!=cpu_Done && state!=cpu_Crashed)
+  {
+    uint32_t ms=Avr->cycle/(F_CPU/1000);
+    while(next<ScriptLen && Script[next].ms<=ms)        //fällige Stimuli anlegen
+    {
+      Stimulus *s=&Script[next++];
+      if(s->bit==-1)
+        Temp=s->value;
+      else if(s->bit==-2)
+        endMs=s->ms;
+      else
+        set_Pin(s->port, s->bit, s->value!=0);
+    }
+    if(ms>=endMs)
+      break;
+
+    avr_cycle_count_t before=Avr->cycle;
+    int sleeping=(state==cpu_Sleeping);
+    state=avr_run(Avr);
+    if(sleeping)
+      Asleep+=Avr->cycle-before;
+
+    int i=Avr->sreg[S_I];
+    if(Avr->pc>0 && Avr->pc<VECT_END && !i)              //Sprung in einen Interruptvektor
+    {
+      inVector=1;
+      if(Avr->pc==VECT_TICK)
+        isrStart=Avr->cycle;
+    }
+    if(sei && !i)                                       //Interrupts gesperrt
+    {
+      cliStart=Avr->cycle;
+      DdrToggled=0;
+    }
+    else if(!sei && i)                                  //wieder freigegeben
+    {
+      uint64_t len=Avr->cycle-cliStart;
+      if(isrStart)
+      {
+        stat_Add(&Isr, Avr->cycle-isrStart);
+        isrStart=0;
+      }
+      if(inVector)
+        stat_Add(&CliIsr, len);
+      else if(DdrToggled)
+        stat_Add(&CliOneWire, len);
+      else
+        stat_Add(&CliOther, len);
+      inVector=0;
+    }
+    sei=i;
+  }
+
+  printf("{\"cycles\":%llu,", (unsigned long long)Avr->cycle);
+  printf("\"boot_decide_us\":%.2f,", US(Decide));
+  printf("\"awake_pct\":%.2f,", Avr->cycle ? 100.0*(Avr->cycle-Asleep)/Avr->cycle : 0.0);
+  print_Stat("loop", &Loop, 0);
+  print_Stat("loop_period", &LoopPeriod, 0);
+  print_Stat("isr_tick", &Isr, 0);
+  printf("\"isr_tick_max_cycles\":%llu,", (unsigned long long)Isr.max);
+  print_Stat("cli_onewire", &CliOneWire, 0);
+  print_Stat("cli_isr", &CliIsr, 0);
+  print_Stat("cli_other", &CliOther, 0);
+  printf("\"i2c\":{\"bytes\":%u,\"frames\":%llu,\"bytes_per_frame_mean\":%.2f,"
+         "\"bytes_per_frame_max\":%llu}}\n",
+         (unsigned)I2cTotal, (unsigned long long)Frame.count,
+         Frame.count ? (double)Frame.sum/Frame.count : 0.0, (unsigned long long)Frame.max);
+  return state==cpu_Crashed ? 2 : 0;
+}
@@ -0,0 +1,26 @@
+/*
+Titel     : Messmarken für den Benchmark unter simavr
+--------------------------------------------------------------------------------------
+Funktion  : Mit -DBENCH (Umgebung "bench") schreibt die Firmware an ausgewählten
+            Stellen eine Kennung in GPIOR0. Das Register hat keine Wirkung auf die
+            Hardware, kostet einen Takt (out) und wird von bench/simbench.c
+            beobachtet. Ohne BENCH entfallen die Marken vollständig.
+--------------------------------------------------------------------------------------
+*/
+#ifndef BENCH_H
+#define BENCH_H
+
+//--------------------------------------- Defines -------------------------------------
+#define MARK_LOOP 1                                     //Beginn von loop()
+#define MARK_LOOP_END 2                                 //Ende von loop()
+#define MARK_FRAME 3                                    //Bildspeicher an das Display übergeben
+#define MARK_DECIDE 4                                   //erste Relaisentscheidung nach dem Reset
+
+#if defined(BENCH) && defined(ARDUINO)
+#include <avr/io.h>
+#define BENCH_MARK(id) (GPIOR0=(id))
+#else
+#define BENCH_MARK(id)
+#endif
+
+#endif
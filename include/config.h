@@ -0,0 +1,50 @@
+/*
+Titel     : Einstellungen im EEPROM
+--------------------------------------------------------------------------------------
+Funktion  : Jahreszeit, Einschaltlevel, Nachlaufzeit und Frostgrenze überstehen
+            einen Stromausfall. Ein Eintrag hat 8 Byte mit Folgenummer und CRC-8,
+            die Einträge bilden einen Ring über CFG_SLOTS Plätze ab EE_CONFIG.
+            Beim Start wird der Ring einmal gelesen, es gilt der gültige Eintrag
+            mit der höchsten Folgenummer. Geschrieben wird nur bei einer Änderung,
+            und zwar immer auf den nächsten Platz; ein unterbrochener Schreibvorgang
+            fällt an der CRC auf, dann gilt der Eintrag davor.
+            Ist die Schreibwarteschlange der HAL voll, merkt sich cfg_Save() den
+            Eintrag; cfg_Flush() aus der Steuerung reiht ihn ein, sobald Platz ist.
+            Bei 32 Plätzen und 100000 Zyklen je Byte reichen 3,2 Mio. Änderungen,
+            bei zehn Änderungen am Tag also rund 870 Jahre.
+--------------------------------------------------------------------------------------
+*/
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define SOMMER 1                                        //Deffinition Jahreszeit
+#define WINTER 0
+#define FROSTTEMP 2                                     //Vorgabe: Umschalttemperatur für Frosterkennung
+#define ONTIME 60                                       //Vorgabe: Nachlaufzeit der Pumpe in Sekunden (60)
+
+#define CFG_VERSION 1                                   //bei geändertem Aufbau erhöhen
+#define CFG_SLOTS 32                                    //Plätze im Ring
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint8_t seq;                                          //Folgenummer, der neueste Eintrag gilt
+  uint8_t version;                                      //CFG_VERSION
+  uint8_t season;                                       //SOMMER/WINTER
+  uint8_t onSummer;                                     //Einschaltlevel im Sommer (IN_LVx)
+  uint8_t onWinter;                                     //Einschaltlevel im Winter (IN_LVx)
+  uint8_t onTime;                                       //Nachlaufzeit der Pumpe in s
+  int8_t frostTemp;                                     //Frostgrenze in °C
+  uint8_t crc;                                          //CRC-8 (Dallas/Maxim) über die Bytes davor
+} Config;
+
+//------------------------------------- Prototypes ------------------------------------
+bool cfg_Load(Config *cfg);                             //neuesten Eintrag laden, false = Vorgaben
+bool cfg_Save(Config *cfg);                             //bei Änderung nächsten Platz schreiben,
+                                                        //false = Warteschlange voll, vorgemerkt
+void cfg_Flush(void);                                   //Vorgemerktes einreihen, kehrt sofort zurück
+
+#endif
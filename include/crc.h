@@ -0,0 +1,19 @@
+/*
+Titel     : Prüfsummen
+--------------------------------------------------------------------------------------
+Funktion  : CRC-8 für die Einträge im EEPROM und CRC-16 für Rahmen über die serielle
+            Schnittstelle. Beide bitweise gerechnet, die Tabellen (256 bzw. 512 Byte)
+            wären für die kurzen Datensätze zu teuer.
+--------------------------------------------------------------------------------------
+*/
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+//------------------------------------- Prototypes ------------------------------------
+uint8_t crc8(const uint8_t *data, uint8_t len);         //CRC-8 (Dallas/Maxim, wie OneWire)
+uint16_t crc16(const uint8_t *data, uint8_t len);       //CRC-16 (Modbus): Polynom 0x8005
+                                                        //gespiegelt, Startwert 0xFFFF
+
+#endif
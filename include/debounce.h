@@ -0,0 +1,33 @@
+/*
+Titel     : Entprellung mit vertikalen Zählern
+--------------------------------------------------------------------------------------
+Funktion  : Filtert acht Eingänge gleichzeitig. Zu jedem Eingang gehört ein Zähler,
+            dessen Bits über mehrere Bytes verteilt sind (Byte k enthält Bit k aller
+            acht Zähler). Damit kostet eine Abtastung nur einige Byte-Operationen je
+            Zählerbit, unabhängig von der Anzahl der Eingänge.
+            Ein Eingang übernimmt einen neuen Zustand erst, wenn er ihn hold-mal in
+            Folge geliefert hat; hold ist je Eingang einstellbar (1..2^DEBOUNCE_PLANES).
+--------------------------------------------------------------------------------------
+*/
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define DEBOUNCE_PLANES 7                               //Zählerbits, max. Haltezeit 128 Abtastungen
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint8_t state;                                        //entprellter Zustand, ein Bit je Eingang
+  uint8_t count[DEBOUNCE_PLANES];                       //Restzähler, Byte k = Bit k aller Zähler
+  uint8_t hold[DEBOUNCE_PLANES];                        //Startwert der Zähler, ebenso verteilt
+} Debounce;
+
+//------------------------------------- Prototypes ------------------------------------
+void debounce_Init(Debounce *d, const uint8_t hold[8], uint8_t state);
+                                                        //Haltezeiten (Abtastungen) je Bit 0..7 setzen
+uint8_t debounce_Update(Debounce *d, uint8_t sample);   //eine Abtastung, liefert umgeschaltete Bits
+
+#endif
@@ -0,0 +1,23 @@
+/*
+Titel     : Aufteilung des EEPROM
+--------------------------------------------------------------------------------------
+Funktion  : Der ATmega328P hat 1KB EEPROM mit je 100000 Schreibzyklen je Byte.
+            Bereiche, die sich oft ändern, liegen als Ring über mehrere Einträge,
+            damit sich die Schreibzugriffe verteilen.
+              0x000-0x00F  Diagnose (Watchdog, siehe hal_avr.cpp)
+              0x010-0x10F  Konfiguration, Ring aus CFG_SLOTS Einträgen à 8 Byte
+              0x110-0x1FF  Pumpenstatistik, Ring aus STATS_SLOTS Einträgen à 16 Byte
+              0x200-0x3FF  Ereignisprotokoll
+--------------------------------------------------------------------------------------
+*/
+#ifndef EEPROM_MAP_H
+#define EEPROM_MAP_H
+
+//--------------------------------------- Defines -------------------------------------
+#define EE_DIAG 0x000                                   //Diagnose, 16 Byte
+#define EE_CONFIG 0x010                                 //Konfigurationsring
+#define EE_STATS 0x110                                  //Statistik
+#define EE_LOG 0x200                                    //Ereignisprotokoll
+#define EE_SIZE 0x400                                   //Größe des EEPROM
+
+#endif
@@ -0,0 +1,59 @@
+/*
+Titel     : Ereignisprotokoll im EEPROM
+--------------------------------------------------------------------------------------
+Funktion  : Pumpe ein/aus, Sondenwechsel, Skimmer, Frost, Jahreszeit, Sensorfehler
+            und Neustarts werden als Datensätze zu 4 Byte in einen Ring ab EE_LOG
+            geschrieben (LOG_SLOTS Plätze, jedes Byte wird erst nach einem vollen
+            Umlauf wieder beschrieben). log_Event() legt den Datensatz nur in einen
+            kleinen Puffer im RAM, log_Flush() reicht ihn an die Schreibwarteschlange
+            der HAL weiter, sobald dort Platz ist. Die Steuerung wartet also nie.
+            Aufbau eines Datensatzes:
+              Byte 0  Bit 7 Umlaufbit, Bit 0..6 Ereigniscode (LOG_xxx)
+              Byte 1  Nutzdaten (je nach Code)
+              Byte 2,3 Sekunden seit dem vorigen Ereignis (bleibt bei 0xFFFF stehen)
+            Das Umlaufbit wechselt mit jedem Umlauf. Beim Start ist die Schreib-
+            position die erste Stelle, an der es sich ändert; ein Lesedurchgang genügt.
+            Byte 0 wird zuletzt geschrieben, ein abgebrochener Datensatz zählt noch
+            zum alten Umlauf.
+--------------------------------------------------------------------------------------
+*/
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define LOG_SLOTS 128                                   //Datensätze im Ring (512 Byte)
+#define LOG_STAGE 8                                     //Datensätze im RAM-Puffer (Zweierpotenz)
+
+#define LOG_BOOT 1                                      //Neustart, Daten: Ursache (RESET_xxx)
+#define LOG_PUMP_ON 2                                   //Relais ein, Daten: Auslöser (PUMP_xxx)
+#define LOG_PUMP_OFF 3                                  //Relais aus, Daten: Auslöser (PUMP_xxx)
+#define LOG_PROBES 4                                    //Sondenwechsel, Daten: Sonden LV0..LV4, SKIM
+#define LOG_SKIM 5                                      //Skimmer hat ausgelöst
+#define LOG_FROST_ON 6                                  //Frost erkannt, Daten: Temperatur in °C
+#define LOG_FROST_OFF 7                                 //Frost vorbei, Daten: Temperatur in °C
+#define LOG_SEASON 8                                    //Jahreszeit gewechselt, Daten: SOMMER/WINTER
+#define LOG_SENSOR_LOST 9                               //Temperatursensor ausgefallen
+#define LOG_SENSOR_OK 10                                //Temperatursensor liefert wieder
+#define LOG_WATCHDOG 11                                 //nach Watchdog-Reset, Daten: hängender Task
+#define LOG_EMPTY 0x7F                                  //Platz noch nie beschrieben
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint8_t code;                                         //LOG_xxx, Bit 7 = Umlaufbit
+  uint8_t data;                                         //Nutzdaten
+  uint16_t delta;                                       //Sekunden seit dem vorigen Ereignis
+} LogRecord;
+
+//------------------------------------- Variablen -------------------------------------
+extern uint8_t LogLost;                                 //verworfene Ereignisse (Puffer voll)
+
+//------------------------------------- Prototypes ------------------------------------
+void log_Init(void);                                    //Schreibposition suchen (512 Byte lesen)
+void log_Event(uint8_t code, uint8_t data);             //Ereignis vormerken, kehrt sofort zurück
+void log_Flush(void);                                   //vorgemerkte Ereignisse einreihen
+bool log_Read(uint8_t age, LogRecord *rec);             //0 = jüngstes im EEPROM, false = keins
+
+#endif
@@ -0,0 +1,91 @@
+/*
+Titel     : Hardware-Abstraktion
+--------------------------------------------------------------------------------------
+Funktion  : Schmale Schnittstelle zwischen Steuerlogik und Hardware. Die Steuerung
+            (main.cpp, Scheduler, Bildspeicher, Entprellung) benutzt ausschließlich
+            diese Funktionen und inputs.h. Für den Nano sind sie in hal_avr.cpp,
+            inputs.cpp und lcd_i2c.cpp umgesetzt, für den Host (Umgebung "native")
+            in hal_native.cpp. Damit übersetzt die Steuerung unverändert auch als
+            Linux-Programm.
+--------------------------------------------------------------------------------------
+*/
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define TEMP_NONE (-7040)                               //Rohwert "kein Sensor" (= DEVICE_DISCONNECTED_RAW)
+#define TEMP_RAW_PER_C 128                              //Rohwert je °C
+#define WDT_MS 2000                                     //Watchdog: Interrupt nach 2s ohne Meldung,
+                                                        //Reset nach weiteren 2s
+
+#define UART_FRAME 64                                   //größter empfangener Rahmen in Byte
+
+#define RESET_POWER 0                                   //Ursache des letzten Resets: Einschalten
+#define RESET_EXTERN 1                                  //Resettaste bzw. Bootloader
+#define RESET_BROWNOUT 2                                //Unterspannung
+#define RESET_WATCHDOG 3                                //Watchdog, Hauptprogramm hing
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint8_t cause;                                        //RESET_xxx
+  uint8_t task;                                         //bei RESET_WATCHDOG: hängender Task (SchedCurrent)
+  uint16_t watchdogs;                                   //Watchdog-Resets insgesamt (EEPROM)
+} ResetInfo;
+
+//------------------------------------- Prototypes ------------------------------------
+void hal_Init(void);                                    //Ein-/Ausgänge und 1ms-Takt für
+                                                        //timer_Tick() einrichten
+
+uint32_t hal_Millis(void);                              //Zeit seit Reset in ms
+uint32_t hal_Micros(void);                              //Zeit seit Reset in µs
+uint8_t hal_Lock(void);                                 //Interrupts sperren, alten Zustand liefern
+void hal_Unlock(uint8_t lock);                          //alten Zustand wiederherstellen
+void hal_Sleep(void);                                   //bis zum nächsten Interrupt schlafen
+
+void hal_WdtInit(void);                                 //Watchdog mit Interrupt und Reset starten
+void hal_WdtKick(void);                                 //Watchdog zurücksetzen (alle Tasks gemeldet)
+void hal_ResetInfo(ResetInfo *info);                    //Ursache des letzten Resets
+
+void hal_EeRead(uint16_t addr, void *data, uint8_t len);//EEPROM lesen (noch eingereihte Bytes nicht)
+bool hal_EeWrite(uint16_t addr, const void *data, uint8_t len);
+                                                        //einreihen, der EE_READY-Interrupt schreibt
+                                                        //im Hintergrund; false = kein Platz, nichts
+                                                        //eingereiht
+uint8_t hal_EeFree(void);                               //freie Bytes in der Schreibwarteschlange,
+                                                        //bis zum nächsten Einreihen nur mehr
+
+void hal_Relay(bool on);                                //Pumpenrelais schalten (auch aus ISR)
+bool hal_RelayState(void);                              //Schaltzustand des Relaisausgangs
+
+
+void hal_LcdInit(void);                                 //Display initialisieren, Licht an
+bool hal_LcdChar(uint8_t location, const uint8_t charmap[8]);
+                                                        //Sonderzeichen 0..7 laden, false = kein
+                                                        //Platz im Puffer, nichts eingereiht
+bool hal_LcdWrite(uint8_t col, uint8_t row, const uint8_t *text, uint8_t len);
+                                                        //Zeichen ab col/row ausgeben, false =
+                                                        //kein Platz im Sendepuffer, später erneut
+uint8_t hal_LcdErrors(void);                            //Fehlerzähler, Änderung = Inhalt verloren
+void hal_LcdSync(void);                                 //warten, bis alles übertragen ist
+
+void hal_SerialInit(void);                              //UART mit 115200 Baud (nur mit PROFILE)
+int16_t hal_SerialRead(void);                           //empfangenes Zeichen, -1 = keins
+void hal_SerialWrite(const char *text);                 //Text senden
+
+void hal_UartInit(uint32_t baud, bool parity);          //UART 8N1 bzw. 8E1, Sendepuffer im Interrupt
+                                                        //(nur mit TELEMETRY oder MODBUS)
+bool hal_UartSend(const uint8_t *data, uint8_t len);    //einreihen, false = kein Platz, nichts
+                                                        //eingereiht
+uint8_t hal_UartFrame(const uint8_t **data);            //Länge eines nach 3,5 Zeichen Pause
+                                                        //vollständigen Rahmens, 0 = keiner (MODBUS)
+void hal_UartNext(void);                                //Rahmen verarbeitet, nächsten empfangen
+
+void hal_TempInit(void);                                //Bus starten, Sensor suchen
+void hal_TempStart(void);                               //Wandlung anstoßen, kehrt sofort zurück
+uint16_t hal_TempConvTime(void);                        //Wandlungszeit in ms
+int16_t hal_TempRead(void);                             //Ergebnis als Rohwert, TEMP_NONE bei Fehler
+
+#endif
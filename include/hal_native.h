@@ -0,0 +1,39 @@
+/*
+Titel     : Hardware-Abstraktion für den Host (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Ersetzt Nano, Display und Temperatursensor durch Variablen. Die Zeit
+            läuft nur über sim_Advance() weiter, der 1ms-Takt des Zeitrads wird
+            dabei wie vom Timer2-Interrupt aufgerufen. Eingänge werden mit
+            sim_SetInputs() gesetzt, read_Inputs() liefert sie wie die Ports.
+            Der Watchdog zählt in sim_Advance() mit. Sein Reset kehrt über
+            sim_Reset() nicht zurück, der Simulator startet dann setup() neu.
+--------------------------------------------------------------------------------------
+*/
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+//------------------------------------- Variablen -------------------------------------
+extern int16_t SimTempRaw;                              //Messwert des Sensors (1/128°C), TEMP_NONE = ab
+extern uint32_t SimLcdChars;                            //bisher ans Display übertragene Zeichen
+extern double SimAwakeUs;                               //geschätzte Wachzeit der CPU in µs
+extern double SimConvUs;                                //Dauer aller Temperaturwandlungen in µs
+extern bool SimSleep;                                   //loop() hat hal_Sleep() aufgerufen
+extern bool SimHang;                                    //nächster Sensorzugriff hängt (sim_Stall)
+extern uint32_t SimEeWrites[];                          //Schreibzyklen je EEPROM-Byte
+extern FILE *SimUart;                                   //Ziel der UART-Ausgabe, NULL = verwerfen
+extern bool SimUartHex;                                 //UART-Ausgabe als Hex auf stdout (Modbus)
+extern uint8_t SimEeFree;                               //freie Bytes der nachgebildeten EEPROM-
+                                                        //Warteschlange, 0xFF = unbegrenzt (Tests)
+
+//------------------------------------- Prototypes ------------------------------------
+void sim_Advance(uint32_t us);                          //virtuelle Zeit vorstellen, Interrupts auslösen
+double sim_Time(void);                                  //virtuelle Zeit in s, ohne den Überlauf von hal_Millis()
+void sim_SetInputs(uint8_t state);                      //Eingangsabbild (IN_xxx) vorgeben
+const char *sim_LcdLine(uint8_t row);                   //Displayzeile als Text (Sonderzeichen als '0'..'7')
+void sim_UartFrame(const uint8_t *data, uint8_t len);   //Rahmen empfangen (wie nach 3,5 Zeichen Pause)
+void sim_EeErase(void);                                 //EEPROM wie ein neuer Chip (Tests)
+
+#endif
@@ -0,0 +1,37 @@
+/*
+Titel     : Zulaufschätzung und vorausschauendes Abpumpen
+--------------------------------------------------------------------------------------
+Funktion  : Aus den Zeitpunkten, zu denen zwei übereinanderliegende Sonden
+            nacheinander nass werden (LV0 -> LV1 -> ... -> LV4 -> SKIM), ergibt
+            sich die Steiggeschwindigkeit des Pegels und damit der Zulauf. Die
+            Sondenhöhen stehen in tank.h. Gerechnet wird ganzzahlig in mm/h und
+            ms, je Sondenwechsel eine feste Zahl von Schritten (zwei Divisionen).
+            Reicht der geschätzte Zulauf, die Zisterne binnen INFLOW_MARGIN ms zum
+            Überlaufen zu bringen, noch bevor die nächste Sonde erreicht sein
+            müsste, meldet inflow_Alarm() ab dem errechneten Zeitpunkt; die
+            Steuerung pumpt dann früher an, nicht erst am Einschaltlevel.
+            Fallende Sonden und jeder Wechsel des Relais beenden den Anstieg und
+            nehmen den Alarm zurück, weil sich dann die Steigung ändert; der
+            zuletzt gemessene Zulauf bleibt lesbar.
+--------------------------------------------------------------------------------------
+*/
+#ifndef INFLOW_H
+#define INFLOW_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#ifndef INFLOW_MARGIN                                   //mit -DINFLOW_MARGIN=0 abgeschaltet
+#define INFLOW_MARGIN 600000UL                          //Vorlauf vor dem Überlauf in ms (10 min)
+#endif
+
+//------------------------------------- Variablen -------------------------------------
+extern uint32_t InflowRate;                             //zuletzt gemessener Anstieg in mm/h, 0 = keiner
+
+//------------------------------------- Prototypes ------------------------------------
+void inflow_Init(uint8_t inputs);                       //Ausgangslage der Sonden übernehmen
+void inflow_Update(uint8_t inputs, bool relay);         //je Abtastung, rechnet nur bei Wechseln
+bool inflow_Alarm(void);                                //Überlauf droht, früher abpumpen
+uint16_t inflow_Liters(void);                           //Zulauf in l/h (bei laufender Pumpe netto)
+
+#endif
@@ -0,0 +1,36 @@
+/*
+Titel     : Eingangsabbild
+--------------------------------------------------------------------------------------
+Funktion  : Liest alle Sonden, den Skimmer und beide Taster mit einem Zugriff auf
+            PIND/PINB und packt sie in ein Byte. Alle Entscheidungen eines Durchlaufs
+            arbeiten mit diesem einen, in sich stimmigen Abbild. Taster sind im
+            Abbild H-aktiv (gedrückt = 1).
+            task_Control liest das Abbild alle SAMPLETIME (10ms) und entprellt es;
+            eine Flanke wirkt also nach der Haltezeit des Eingangs plus höchstens
+            einer Abtastperiode. Pin-Change-Interrupts brächten dabei nichts: jedes
+            Prellen der Sonden weckte die CPU, entschieden würde trotzdem erst
+            nach der Entprellung.
+            Umsetzung für den Nano in inputs.cpp, für den Host in hal_native.cpp.
+--------------------------------------------------------------------------------------
+*/
+#ifndef INPUTS_H
+#define INPUTS_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define IN_LV0 0x01                                     //Konduktivsonde Level 0 (D7, PD7)
+#define IN_LV1 0x02                                     //Konduktivsonde Level 1 (D6, PD6)
+#define IN_LV2 0x04                                     //Konduktivsonde Level 2 (D4, PD4)
+#define IN_LV3 0x08                                     //Konduktivsonde Level 3 (D5, PD5)
+#define IN_LV4 0x10                                     //Konduktivsonde Level 4 (D3, PD3)
+#define IN_SKIM 0x20                                    //Skimmerschalter (D2, PD2)
+#define IN_ON 0x40                                      //Taster EIN gedrückt (D10, PB2)
+#define IN_OFF 0x80                                     //Taster AUS gedrückt (D11, PB3)
+#define IN_LEVELS 0x1F                                  //alle Sonden LV0..LV4
+
+
+//------------------------------------- Prototypes ------------------------------------
+uint8_t read_Inputs(void);                              //Eingangsabbild aufnehmen
+
+#endif
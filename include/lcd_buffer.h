@@ -0,0 +1,45 @@
+/*
+Titel     : Bildspeicher für das LCD
+--------------------------------------------------------------------------------------
+Funktion  : Schattenkopie des Displayinhalts im RAM. Ausgaben landen nur im Puffer,
+            geänderte Zellen werden je Zeile in einer Bitmaske markiert. flush()
+            überträgt ausschließlich diese Zellen, zusammenhängende Zellen mit nur
+            einem setCursor(). Bei unverändertem Inhalt entsteht kein I²C-Verkehr.
+            Passt ein Lauf nicht mehr in den Sendepuffer des Displays, bleibt er
+            markiert und geht mit dem nächsten flush() hinaus.
+--------------------------------------------------------------------------------------
+*/
+#ifndef LCD_BUFFER_H
+#define LCD_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define LCD_COLS 16                                     //Zeichen je Zeile (max. 16, siehe Dirty)
+#define LCD_ROWS 2                                      //Anzahl Zeilen
+
+//--------------------------------------- Klasse --------------------------------------
+class LcdBuffer
+{
+public:
+  LcdBuffer();
+  void init(void);                                      //Zustand wie nach dem Einschalten (setup)
+  void setCursor(uint8_t col, uint8_t row);             //Schreibposition im Puffer setzen
+  size_t write(uint8_t value);                          //Zeichen in den Puffer schreiben
+  size_t print(const char *text);                       //Zeichenkette in den Puffer schreiben
+  size_t print(int value);                              //Ganzzahl dezimal in den Puffer schreiben
+  void clear(void);                                     //Puffer mit Leerzeichen füllen, Cursor auf 0,0
+  void invalidate(void);                                //alle Zellen neu übertragen (nach LCD-Reset)
+  bool lost(void);                                      //Bus hat Daten verworfen, Zellen sind neu zu senden
+  void flush(void);                                     //geänderte Zellen zum Display senden
+
+private:
+  uint8_t Cells[LCD_ROWS][LCD_COLS];                    //Sollinhalt des Displays
+  uint16_t Dirty[LCD_ROWS];                             //je Zeile: Bit n = Zelle n geändert
+  uint8_t Col;                                          //aktuelle Schreibposition
+  uint8_t Row;
+  uint8_t Errors;                                       //zuletzt gesehener Fehlerzähler des Displays
+};
+
+#endif
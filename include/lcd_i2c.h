@@ -0,0 +1,83 @@
+/*
+Titel     : HD44780-Treiber über PCF8574 (I²C)
+--------------------------------------------------------------------------------------
+Funktion  : Ersetzt LiquidCrystal_I2C und die Wire-Library. Befehle und Zeichen für
+            das Display werden in einen Ringpuffer gestellt, den die TWI-Interrupt-
+            routine Byte für Byte zum PCF8574 schiebt. Ausgaben kehren sofort zurück,
+            auch bei vollem Puffer (der Eintrag wird dann verworfen und zählt als
+            Fehler) und bei hängendem Bus.
+            Der Enable-Puls und die Wartezeiten des HD44780 ergeben sich aus der
+            Bytedauer auf dem Bus (90µs bei 100kHz); längere Wartezeiten (Löschen,
+            Initialisierung) werden als Füllbytes mit unverändertem Portzustand
+            eingereiht.
+--------------------------------------------------------------------------------------
+*/
+#ifndef LCD_I2C_H
+#define LCD_I2C_H
+
+#include <Arduino.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define LCD_CLEARDISPLAY 0x01                           //HD44780-Befehle
+#define LCD_RETURNHOME 0x02
+#define LCD_ENTRYMODESET 0x04
+#define LCD_DISPLAYCONTROL 0x08
+#define LCD_FUNCTIONSET 0x20
+#define LCD_SETCGRAMADDR 0x40
+#define LCD_SETDDRAMADDR 0x80
+
+#define LCD_ENTRYLEFT 0x02                              //Flags für die Befehle
+#define LCD_DISPLAYON 0x04
+#define LCD_4BITMODE 0x00
+#define LCD_2LINE 0x08
+#define LCD_5x8DOTS 0x00
+
+#define LCD_BACKLIGHT 0x08                              //Portbits am PCF8574
+#define LCD_EN 0x04                                     //Enable
+#define LCD_RS 0x01                                     //Register Select (1=Daten)
+
+#define LCD_QUEUE 64                                    //Einträge im Ringpuffer (Zweierpotenz)
+#define LCD_I2C_CLOCK 100000UL                          //Bustakt in Hz
+#define LCD_BYTE_US 90                                  //Dauer eines Bytes mit ACK in µs
+
+//--------------------------------------- Klasse --------------------------------------
+class LcdI2C : public Print
+{
+public:
+  LcdI2C(uint8_t addr);
+  void init(void);                                      //TWI einrichten, Initialisierung einreihen
+  void backlight(void);                                 //Hintergrundlicht an
+  void clear(void);                                     //Display löschen
+  void home(void);                                      //Cursor auf 0,0
+  void setCursor(uint8_t col, uint8_t row);
+  void createChar(uint8_t location, const uint8_t charmap[]);
+  void command(uint8_t value);
+  size_t write(uint8_t value);                          //Zeichen einreihen, 0 = Puffer voll
+  size_t write(const uint8_t *buffer, size_t size);
+  uint8_t space(void);                                  //freie Einträge im Ringpuffer
+  bool idle(void);                                      //Puffer leer und Bus frei?
+  void sync(void);                                      //warten, bis alles übertragen ist
+  volatile uint8_t Errors;                              //Busfehler, hängender Bus, verworfene
+                                                        //Einträge; läuft über
+  void isr(void);                                       //nur für ISR(TWI_vect)
+
+private:
+  bool push(uint8_t ctrl, uint8_t value);               //Eintrag in den Ringpuffer, false = voll
+  void pause(uint16_t us);                              //Wartezeit als Füllbytes einreihen
+  void kick(void);                                      //Übertragung starten, falls Bus frei
+  int16_t next(void);                                   //nächstes Byte für den PCF8574 (ISR)
+  uint8_t Addr;                                         //I²C-Adresse des PCF8574
+  uint8_t Backlight;                                    //Backlight-Bit für jede Ausgabe
+  uint8_t Ctrl[LCD_QUEUE];                              //Art des Eintrags (siehe lcd_i2c.cpp)
+  uint8_t Value[LCD_QUEUE];                             //Befehl, Zeichen oder Anzahl Füllbytes
+  volatile uint8_t Head;                                //Schreibindex (Hauptprogramm)
+  volatile uint8_t Tail;                                //Leseindex (ISR)
+  volatile bool Busy;                                   //Übertragung läuft
+  uint8_t Seq[6];                                       //Portzustände des aktuellen Eintrags (ISR)
+  uint8_t SeqLen;
+  uint8_t SeqPos;
+  uint8_t Fill;                                         //noch auszugebende Füllbytes (ISR)
+  uint8_t Port;                                         //zuletzt ausgegebener Portzustand (ISR)
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*
+Titel     : Modbus-RTU-Slave für die Hausautomation
+--------------------------------------------------------------------------------------
+Funktion  : Mit -DMODBUS antwortet die Steuerung als Slave MB_ADDR über den UART
+            (MB_BAUD, 8E1). Die HAL sammelt einen Rahmen im Interrupt und erkennt
+            sein Ende an 3,5 Zeichen Pause (Timer1). mb_Task prüft CRC und Adresse,
+            bearbeitet ihn und reiht die Antwort in den Sendepuffer ein; die
+            Steuerung wartet also weder auf den Master noch auf die Leitung.
+            Funktionen: 03 Holding Register lesen, 04 Input Register lesen,
+            06 ein Register schreiben, 16 mehrere Register schreiben.
+            Adresse 0 (Broadcast) schreibt ohne Antwort.
+            Die Register selbst stellt main.cpp über mb_Input(), mb_Holding() und
+            mb_Write() bereit.
+            Input Register (nur lesen):
+              0  entprelltes Eingangsabbild (IN_xxx)
+              1  höchste benetzte Sonde, 0 = keine, 1..5 = LV0..LV4
+              2  Temperatur in 1/10°C, MB_NONE = kein Sensor
+              3  Rohwert des DS18B20 in 1/128°C
+              4  Relais (0/1)
+              5  restliche Nachlaufzeit in 1/10 s
+              6  Frost erkannt (0/1)
+              7  Fehler: Bit 0 Sensor, Bit 2 Protokoll voll (Bit 1 frei)
+              8  Pumpenstarts insgesamt (bleibt bei 65535 stehen)
+              9  Pumpenlaufzeit insgesamt in h
+             10  Ursache des letzten Resets (RESET_xxx)
+             11  Watchdog-Resets insgesamt
+             12  Modbus-Rahmen mit CRC-Fehler
+             13  längster Pumpenlauf in s
+             14  Tastgrad der letzten vollen Stunde in 1/100 %
+             15  Tastgrad des letzten vollen Tages in 1/100 %
+             16  höchster Tastgrad eines Tages in 1/100 %
+             17  zuletzt gemessener Zulauf in l/h, 0 = noch keiner (bei laufender
+                 Pumpe netto)
+             18..33  Ereignisprotokoll, MB_LOG_WINDOW Einträge ab dem Alter in HR 6,
+                 je Eintrag zwei Register: Code*256+Nutzdaten (0 = kein Eintrag,
+                 LOG_xxx in eventlog.h) und Sekunden seit dem vorigen Eintrag.
+                 Gelesen wird das EEPROM, noch vorgemerkte Einträge fehlen
+            Holding Register (lesen und schreiben):
+              0  Jahreszeit, 0 = WINTER, 1 = SOMMER
+              1  Nachlaufzeit in s (1..255)
+              2  Frostgrenze in °C (-20..20, Zweierkomplement)
+              3  Einschaltlevel Sommer, 3..5 = LV2..LV4
+              4  Einschaltlevel Winter, 3..5 = LV2..LV4
+              5  Pumpe von Hand: 1 = ein (wie Taster EIN), 0 = aus (wie Taster AUS),
+                 gelesen der Relaiszustand
+              6  Alter des ersten Eintrags im Protokollfenster, 0 = jüngster
+                 (0..127, nur RAM)
+            Ungültige Werte beantwortet der Slave mit Ausnahme 03, Pumpe ein bei
+            Frost oder Sensorfehler mit 04. Geschriebene Einstellungen gelten
+            sofort; ist die EEPROM-Warteschlange voll, holt cfg_Flush() das
+            Speichern nach. Teilt sich den UART mit PROFILE und TELEMETRY.
+--------------------------------------------------------------------------------------
+*/
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include <stdint.h>
+
+#if defined(MODBUS) && (defined(TELEMETRY) || defined(PROFILE))
+#error "MODBUS, TELEMETRY und PROFILE benutzen alle den UART"
+#endif
+
+//--------------------------------------- Defines -------------------------------------
+#define MB_ADDR 1                                       //eigene Slave-Adresse
+#define MB_BAUD 19200                                   //Vorgabe der Modbus-Spezifikation
+#define MB_REGS_MAX 16                                  //Register je Anfrage
+#define MB_PERIOD 10                                    //Abfrage des Empfangspuffers in ms
+#define MB_NONE 0x8000                                  //Registerwert "unbekannt"
+
+#define MB_EX_FUNCTION 1                                //Ausnahme: Funktion nicht unterstützt
+#define MB_EX_ADDRESS 2                                 //Ausnahme: Register gibt es nicht
+#define MB_EX_VALUE 3                                   //Ausnahme: Wert oder Anzahl ungültig
+#define MB_EX_FAIL 4                                    //Ausnahme: im aktuellen Zustand nicht möglich
+
+#define MB_IR_INPUTS 0                                  //Input Register, siehe oben
+#define MB_IR_LEVEL 1
+#define MB_IR_TEMP 2
+#define MB_IR_TEMPRAW 3
+#define MB_IR_RELAY 4
+#define MB_IR_RUNON 5
+#define MB_IR_FROST 6
+#define MB_IR_FAULTS 7
+#define MB_IR_STARTS 8
+#define MB_IR_RUNTIME 9
+#define MB_IR_RESET 10
+#define MB_IR_WATCHDOGS 11
+#define MB_IR_CRCERRORS 12
+#define MB_IR_LONGEST 13
+#define MB_IR_DUTYHOUR 14
+#define MB_IR_DUTYDAY 15
+#define MB_IR_DUTYMAX 16
+#define MB_IR_INFLOW 17
+#define MB_IR_LOG 18                                    //erstes Register des Protokollfensters
+#define MB_LOG_WINDOW 8                                 //Einträge im Fenster, 2 Register je Eintrag
+#define MB_IR_COUNT (MB_IR_LOG+2*MB_LOG_WINDOW)
+
+#define MB_HR_SEASON 0                                  //Holding Register, siehe oben
+#define MB_HR_ONTIME 1
+#define MB_HR_FROST 2
+#define MB_HR_ONSUMMER 3
+#define MB_HR_ONWINTER 4
+#define MB_HR_PUMP 5
+#define MB_HR_LOGAGE 6
+#define MB_HR_COUNT 7
+
+#ifdef MODBUS                                           //Eintrag für die Tasktabelle
+#define MB_TASK() TASK(mb_Task, MB_PERIOD, MB_PERIOD),
+#else
+#define MB_TASK()
+#endif
+
+//------------------------------------- Variablen -------------------------------------
+extern uint16_t MbCrcErrors;                            //verworfene Rahmen mit falscher CRC
+
+//------------------------------------- Prototypes ------------------------------------
+void mb_Init(void);                                     //UART und Pausentimer einrichten
+void mb_Task(void);                                     //Task: empfangenen Rahmen bearbeiten
+bool mb_Input(uint16_t reg, uint16_t *value);           //in main.cpp: Input Register lesen,
+bool mb_Holding(uint16_t reg, uint16_t *value);         //Holding Register lesen, false = gibt es nicht
+uint8_t mb_Write(uint16_t reg, uint16_t value);         //in main.cpp: schreiben, 0 oder MB_EX_xxx
+
+#endif
@@ -0,0 +1,56 @@
+/*
+Titel     : Laufzeitprofil im Zielsystem
+--------------------------------------------------------------------------------------
+Funktion  : Nur mit -DPROFILE (Umgebung "profile") aktiv. PROF_BEGIN/PROF_END
+            nehmen für einen Messpunkt die Zeit zwischen Ein- und Austritt mit dem
+            freilaufenden Timer0 (hal_Micros, 4µs Auflösung) und führen Anzahl,
+            Minimum, Maximum und Summe mit (10 Byte je Messpunkt). prof_Loop()
+            misst die Periode von loop() in einem log2-Histogramm (32 Byte).
+            Ein 'p' über die serielle Schnittstelle (115200 Baud) gibt alles aus,
+            ein 'r' setzt die Werte zurück, ein 'l' gibt das Ereignisprotokoll aus.
+            Ohne PROFILE sind alle Makros leer und es entsteht kein Code.
+--------------------------------------------------------------------------------------
+*/
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define PROF_TEMP 0                                     //get_Temp()
+#define PROF_LEVEL 1                                    //show_Level()
+#define PROF_WHEEL 2                                    //move_Wheel()
+#define PROF_BUTTONS 3                                  //Tasterauswertung in eval_Control()
+#define PROF_TICK 4                                     //1ms-Interrupt des Zeitrads (Timer2)
+#define PROF_POINTS 5                                   //Anzahl der Messpunkte
+#define PROF_BUCKETS 16                                 //Histogramm: Fach k = Periode < 2^k µs
+
+#ifdef PROFILE
+#define PROF_BEGIN(id) uint32_t prof_##id=hal_Micros()
+#define PROF_END(id) prof_Add(id, hal_Micros()-prof_##id)
+#define PROF_LOOP() prof_Loop()
+#define PROF_TASK() TASK(prof_Task, 100, 100),
+#else
+#define PROF_BEGIN(id)
+#define PROF_END(id)
+#define PROF_LOOP()
+#define PROF_TASK()
+#endif
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint16_t count;                                       //Anzahl der Messungen (bleibt bei 0xFFFF stehen)
+  uint16_t min;                                         //kürzeste Laufzeit in µs
+  uint16_t max;                                         //längste Laufzeit in µs
+  uint32_t sum;                                         //Summe aller Laufzeiten in µs
+} ProfStat;
+
+//------------------------------------- Prototypes ------------------------------------
+void prof_Init(void);                                   //Werte löschen, Schnittstelle öffnen
+void prof_Add(uint8_t id, uint32_t us);                 //eine Laufzeit eintragen (auch aus ISR)
+void prof_Loop(void);                                   //Periode von loop() erfassen
+void prof_Task(void);                                   //Kommandos 'p', 'r' und 'l' bearbeiten
+void prof_Dump(void);                                   //alle Werte seriell ausgeben
+
+#endif
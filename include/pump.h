@@ -0,0 +1,65 @@
+/*
+Titel     : Pumpenrelais und Betriebsstatistik
+--------------------------------------------------------------------------------------
+Funktion  : Alle Schaltvorgänge des Relais laufen über pump_Set(), aus dem
+            Hauptprogramm wie aus dem Interrupt des Zeitrads (Nachlauf). Jeder
+            Wechsel bekommt Zeitpunkt und Auslöser (PUMP_xxx). Daraus entstehen
+            Starts, Gesamtlaufzeit, längster Lauf und der Tastgrad (Anteil der
+            Laufzeit) der letzten vollen Stunde und des letzten vollen Tages, alles
+            ganzzahlig: Zeiten in s, Tastgrade in 1/100 %.
+            Stunde und Tag zählen ab dem Start, die Steuerung hat keine Uhr.
+            Die Summen stehen in einem Ring aus STATS_SLOTS Einträgen à 16 Byte
+            mit Folgenummer und CRC-8 ab EE_STATS und werden höchstens einmal je
+            Stunde geschrieben (nach einem Stromausfall fehlt also höchstens die
+            letzte Stunde): 24 Einträge am Tag, je Platz alle 15 h ein Zyklus,
+            100000 Zyklen reichen damit über 150 Jahre.
+            Nur ISR(WDT_vect) schaltet am Modul vorbei ab, der Reset folgt ohnehin.
+--------------------------------------------------------------------------------------
+*/
+#ifndef PUMP_H
+#define PUMP_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define PUMP_LEVEL 1                                    //Auslöser: Einschaltlevel oder Skimmer
+#define PUMP_BUTTON 2                                   //Taster EIN/AUS
+#define PUMP_RUNON 3                                    //Nachlaufzeit abgelaufen
+#define PUMP_FROST 4                                    //Frost erkannt
+#define PUMP_MODBUS 5                                   //Befehl über Modbus
+#define PUMP_PREDICT 6                                  //Zulauf lässt Überlauf erwarten (inflow.h)
+
+#define STATS_SLOTS 15                                  //Plätze im Ring (240 Byte)
+#define DUTY_FULL 10000                                 //Tastgrad 100% in 1/100 %
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint32_t starts;                                      //Einschaltvorgänge insgesamt
+  uint32_t runtime;                                     //Laufzeit insgesamt in s
+  uint32_t longest;                                     //längster Lauf in s
+  uint16_t dutyMax;                                     //höchster Tastgrad eines Tages in 1/100 %
+  uint8_t seq;                                          //Folgenummer, der neueste Eintrag gilt
+  uint8_t crc;                                          //CRC-8 über die Bytes davor
+} PumpStats;
+
+typedef struct
+{
+  uint32_t at;                                          //Zeitpunkt des letzten Wechsels in ms
+  uint8_t source;                                       //dessen Auslöser (PUMP_xxx)
+  uint16_t dutyHour;                                    //Tastgrad der letzten vollen Stunde
+  uint16_t dutyDay;                                     //Tastgrad des letzten vollen Tages
+} PumpState;
+
+//------------------------------------- Variablen -------------------------------------
+extern PumpStats Stats;                                 //Summen, ohne den laufenden Lauf
+extern volatile PumpState Pump;                         //letzter Wechsel und Tastgrade
+
+//------------------------------------- Prototypes ------------------------------------
+void pump_Init(void);                                   //Summen aus dem EEPROM laden (240 Byte)
+void pump_Set(bool on, uint8_t source);                 //Relais schalten (auch aus ISR)
+void pump_Task(void);                                   //Task (1s): Laufzeit, Stunde, Tag, Speichern
+uint32_t pump_Runtime(void);                            //Gesamtlaufzeit samt laufendem Lauf in s
+void pump_Stats(PumpStats *stats);                      //Summen gesperrt kopieren (pump_Set im ISR)
+
+#endif
@@ -0,0 +1,45 @@
+/*
+Titel     : Kooperativer Scheduler
+--------------------------------------------------------------------------------------
+Funktion  : Ruft Tasks mit fester Periode aus loop() heraus auf. Die Tasktabelle wird
+            statisch angelegt. Je Task werden Laufzeit und Terminüberschreitungen
+            mitgeführt, damit die Latenz der Hauptschleife messbar bleibt.
+            Jeder Task meldet sich nach seiner Rückkehr an, sched_Alive() liefert
+            true, sobald alle Tasks seit dem letzten Mal gelaufen sind (Watchdog).
+            Höchstens 8 Tasks.
+--------------------------------------------------------------------------------------
+*/
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  void (*func)(void);                                   //Taskfunktion, muss kurz sein und zurückkehren
+  uint16_t period;                                      //Aufrufperiode in ms
+  uint16_t deadline;                                    //erlaubte Zeit von Freigabe bis Taskende in ms
+  uint32_t release;                                     //nächster Freigabezeitpunkt in ms
+  uint16_t runLast;                                     //Laufzeit des letzten Aufrufs in µs
+  uint16_t runMax;                                      //größte gemessene Laufzeit in µs
+  uint16_t overruns;                                    //Anzahl der Terminüberschreitungen
+} Task;
+
+#define SCHED_IDLE 0xFF                                 //SchedCurrent: kein Task läuft
+
+                                                        //Eintrag für die Tasktabelle
+#define TASK(func, period, deadline) { func, period, deadline, 0, 0, 0, 0 }
+
+//------------------------------------- Variablen -------------------------------------
+extern uint16_t SchedLoopMax;                           //längster Durchlauf von sched_Run() in µs,
+                                                        //die Telemetrie setzt ihn je Rahmen zurück
+extern volatile uint8_t SchedCurrent;                   //Index des laufenden Tasks, für die Diagnose
+
+//------------------------------------- Prototypes ------------------------------------
+void sched_Init(Task *tasks, uint8_t count);            //Tasktabelle übernehmen, alle Tasks sofort fällig
+void sched_Run(void);                                   //alle fälligen Tasks einmal ausführen
+uint32_t sched_Idle(void);                              //ms bis zur nächsten Freigabe, 0 = fällig
+bool sched_Alive(void);                                 //alle Tasks seit dem letzten Aufruf gelaufen?
+
+#endif
@@ -0,0 +1,70 @@
+/*
+Titel     : Zisternensimulator
+--------------------------------------------------------------------------------------
+Funktion  : Diskrete Ereignissimulation für den Host. Ein Modell der Zisterne
+            (Wassersäule, Sonden, Dachzulauf nach Regenprofil, Pumpe, Wasser-
+            temperatur) treibt die unveränderte Steuerung aus main.cpp über die
+            virtuelle Uhr von hal_native.cpp. Die Zeit springt jeweils direkt zur
+            nächsten Freigabe des Schedulers, Wartezeiten werden nicht abgesessen.
+            Ein Hänger der Steuerung lässt sich einstreuen, um den Watchdog zu prüfen.
+--------------------------------------------------------------------------------------
+*/
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  double roof;                                          //Dachfläche in m² (1mm Regen = 1 Liter je m²)
+  double pump;                                          //Förderleistung der Pumpe in Liter/h
+  double level;                                         //Anfangspegel in mm
+  uint16_t startDay;                                    //Tag im Jahr zu Simulationsbeginn (0 = 1. Januar)
+  uint32_t seed;                                        //Startwert für das synthetische Regenprofil
+  const char *rain;                                     //Regenprofil (mm/h je Zeile, wird wiederholt),
+                                                        //NULL = synthetisch
+  FILE *trace;                                          //Verlauf je Minute als CSV, NULL = aus
+  double hang;                                          //ab dieser Zeit in s hängt der nächste
+                                                        //Sensorzugriff, 0 = nie
+  FILE *modbus;                                         //Anfragen eines Modbus-Masters, je Zeile
+                                                        //"Sekunde Bytes in Hex" ohne CRC, NULL = aus
+} SimConfig;
+
+typedef struct
+{
+  double rain;                                          //Zulauf vom Dach in Liter
+  double pumped;                                        //abgepumpt in Liter
+  double overflow;                                      //übergelaufen in Liter
+  double overflowTime;                                  //Dauer des Überlaufs in s
+  uint32_t overflows;                                   //Anzahl der Überlaufereignisse
+  double dryRun;                                        //Pumpe an ohne Wasser in s
+  double pumpTime;                                      //Einschaltdauer der Pumpe in s
+  uint32_t pumpStarts;                                  //Anzahl der Einschaltvorgänge
+  double frostTime;                                     //Wasser unter 0°C in s
+  double levelMin;                                      //kleinster Pegel in mm
+  double levelMax;                                      //größter Pegel in mm
+  uint64_t steps;                                       //Durchläufe von loop()
+  double awake;                                         //geschätzte Wachzeit der CPU in s
+  double current;                                       //mittlerer Strom von ATmega328P und
+                                                        //DS18B20 in mA (ohne Board, LCD, Relais)
+  uint32_t hangs;                                       //eingestreute Hänger
+  uint32_t watchdogs;                                   //Resets durch den Watchdog
+  double safeTime;                                      //längste Zeit vom Hänger bis Relais sicher aus in s
+  double recoverTime;                                   //längste Zeit vom Hänger bis zur ersten
+                                                        //Entscheidung nach dem Neustart in s
+} SimStats;
+
+//------------------------------------- Variablen -------------------------------------
+extern SimStats SimResult;                              //Ergebnis des letzten sim_Run()
+
+//------------------------------------- Prototypes ------------------------------------
+bool sim_Init(const SimConfig *config);                 //Modell anlegen, false = Regenprofil fehlt
+void sim_Run(uint32_t seconds);                         //Steuerung und Modell laufen lassen
+double sim_Level(void);                                 //aktueller Pegel in mm
+void sim_Stall(void);                                   //Steuerung hängt, nur Interrupts und Modell laufen
+void sim_WdtEvent(bool reset);                          //Watchdog: Interrupt (false) oder Reset (true)
+void sim_Reset(void);                                   //Reset: zurück in sim_Run(), setup() neu
+
+#endif
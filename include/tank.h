@@ -0,0 +1,26 @@
+/*
+Titel     : Geometrie der Zisterne
+--------------------------------------------------------------------------------------
+Funktion  : Betonzisterne 1m tief mit 1m³ Inhalt, also 1m² Grundfläche: 1 Liter
+            entspricht 1mm Pegel. Angegeben sind die Höhen der Sondenspitzen des
+            Konduktivsensors und des Skimmerschalters über dem Boden. Die Werte
+            gelten für den Nachbau nach Dokumentation und werden vom Simulator
+            und von der Zulaufschätzung (inflow.cpp) benutzt; bei eigenen Sonden
+            hier anpassen.
+--------------------------------------------------------------------------------------
+*/
+#ifndef TANK_H
+#define TANK_H
+
+//--------------------------------------- Defines -------------------------------------
+#define TANK_DEPTH 1000                                 //Höhe bis zum Überlauf in mm
+#define TANK_AREA 1000                                  //Grundfläche in Liter je Meter Pegel (1m²)
+#define TANK_INTAKE 50                                  //Ansaughöhe der Pumpe in mm, darunter Trockenlauf
+#define PROBE_LV0 100                                   //Sondenspitze Level 0 in mm über dem Boden
+#define PROBE_LV1 250                                   //Level 1, Abschaltlevel
+#define PROBE_LV2 500                                   //Level 2, Einschaltlevel WINTER
+#define PROBE_LV3 700                                   //Level 3
+#define PROBE_LV4 850                                   //Level 4, Einschaltlevel SOMMER
+#define PROBE_SKIM 950                                  //Schaltpunkt des Skimmerschalters
+
+#endif
@@ -0,0 +1,79 @@
+/*
+Titel     : Telemetrie über die serielle Schnittstelle
+--------------------------------------------------------------------------------------
+Funktion  : Mit -DTELEMETRY schickt task_Telemetry (main.cpp) alle TELE_PERIOD ms
+            einen Rahmen mit dem Zustand der Steuerung über den UART (115200 Baud,
+            8N1). hal_UartSend() reiht nur in den Sendepuffer ein, gesendet wird im
+            Interrupt; ist der Puffer voll, entfällt der Rahmen und TeleDropped zählt.
+            Rahmen: Nutzdaten (TELE_SIZE Byte, Little Endian), dahinter CRC-16 (Modbus,
+            Low-Byte zuerst), das Ganze COBS-kodiert und mit 0x00 abgeschlossen. Ein
+            Empfänger findet damit nach jeder Störung am nächsten 0x00 wieder Tritt.
+              Byte  0     TELE_VERSION
+              Byte  1     laufende Nummer
+              Byte  2..5  Zeit seit Reset in ms
+              Byte  6     entprelltes Eingangsabbild (IN_xxx)
+              Byte  7,8   Rohwert des DS18B20 in 1/128°C, TEMP_NONE = kein Wert
+              Byte  9     Zustand (TS_xxx)
+              Byte 10,11  restliche Nachlaufzeit in 1/10 s
+              Byte 12,13  längster Durchlauf von sched_Run() seit dem letzten Rahmen in µs
+              Byte 14,15  Terminüberschreitungen aller Tasks seit Reset
+              Byte 16     Fehler (TF_xxx)
+              Byte 17     Ursache des letzten Resets (RESET_xxx)
+              Byte 18     verworfene Rahmen seit Reset
+            Dekodieren nach CSV: tools/telemetry.py. Teilt sich den UART mit PROFILE,
+            daher nur eins von beiden.
+--------------------------------------------------------------------------------------
+*/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#if defined(TELEMETRY) && defined(PROFILE)
+#error "TELEMETRY und PROFILE benutzen beide den UART"
+#endif
+
+//--------------------------------------- Defines -------------------------------------
+#define TELE_PERIOD 100                                 //Rahmenabstand in ms (10 Hz)
+#define TELE_VERSION 1                                  //bei geändertem Aufbau erhöhen
+#define TELE_SIZE 19                                    //Nutzdaten ohne CRC
+
+#define TS_RELAY 0x01                                   //Zustand: Relais an
+#define TS_SOMMER 0x02                                  //Jahreszeit SOMMER
+#define TS_FROST 0x04                                   //Frost erkannt, Pumpe gesperrt
+#define TS_RUNON 0x08                                   //Nachlaufzeit läuft
+
+#define TF_SENSOR 0x01                                  //Fehler: Temperatursensor ausgefallen
+                                                        //0x02 frei (früher Flanken verloren)
+#define TF_LCD 0x04                                     //Übertragung zum Display gestört
+#define TF_LOG 0x08                                     //Ereignisprotokoll kam nicht nach
+
+#ifdef TELEMETRY                                        //Eintrag für die Tasktabelle
+#define TELE_TASK() TASK(task_Telemetry, TELE_PERIOD, TELE_PERIOD),
+#else
+#define TELE_TASK()
+#endif
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct
+{
+  uint32_t time;                                        //ms seit Reset
+  uint8_t inputs;                                       //IN_xxx
+  int16_t tempRaw;                                      //1/128°C, TEMP_NONE
+  uint8_t state;                                        //TS_xxx
+  uint16_t runOn;                                       //restliche Nachlaufzeit in 1/10 s
+  uint16_t loopMax;                                     //längster Durchlauf in µs
+  uint16_t overruns;                                    //Terminüberschreitungen
+  uint8_t faults;                                       //TF_xxx
+  uint8_t reset;                                        //RESET_xxx
+} TeleFrame;
+
+//------------------------------------- Variablen -------------------------------------
+extern uint8_t TeleDropped;                             //verworfene Rahmen (Sendepuffer voll)
+
+//------------------------------------- Prototypes ------------------------------------
+void tele_Init(void);                                   //UART einrichten
+bool tele_Send(const TeleFrame *frame);                 //Rahmen bauen und einreihen, false = verworfen
+void task_Telemetry(void);                              //Task in main.cpp, füllt TeleFrame
+
+#endif
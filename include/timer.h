@@ -0,0 +1,46 @@
+/*
+Titel     : Zeitrad für Verzögerungen und Zeitüberwachungen
+--------------------------------------------------------------------------------------
+Funktion  : Software-Timer auf einem 1ms-Hardwaretakt (Timer2). Die Timer hängen in
+            einem Rad mit TIMER_SLOTS Fächern, Fach = Ablaufzeit modulo Radgröße,
+            längere Zeiten zählen zusätzlich Umläufe. Stellen, Löschen und Ablauf
+            kosten unabhängig von der Anzahl der Timer konstante Zeit.
+            Abgelaufene Timer rufen entweder ihre Funktion auf (im Interrupt, also
+            nur kurze Aktionen wie Relais schalten) oder setzen ein Bit in
+            TimerFlags, das das Hauptprogramm mit timer_Flag() abholt.
+--------------------------------------------------------------------------------------
+*/
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+//--------------------------------------- Defines -------------------------------------
+#define TIMER_SLOTS 64                                  //Fächer im Rad (Zweierpotenz)
+
+                                                        //Timer mit Funktionsaufruf bzw. Flag anlegen
+#define TIMER_CALL(func) { 0, 0, 0, func, 0 }
+#define TIMER_FLAG(flag) { 0, 0, 0, 0, flag }
+
+//--------------------------------------- Typen ---------------------------------------
+typedef struct Timer
+{
+  struct Timer *next;                                   //nächster Timer im selben Fach
+  struct Timer **link;                                  //Zeiger, der auf diesen Timer zeigt, 0 = aus
+  uint16_t rounds;                                      //noch abzuwartende volle Umläufe
+  void (*func)(void);                                   //Aufruf bei Ablauf (Interrupt) oder 0
+  uint8_t flag;                                         //sonst dieses Bit in TimerFlags setzen
+} Timer;
+
+//------------------------------------- Variablen -------------------------------------
+extern volatile uint8_t TimerFlags;                     //abgelaufene Flag-Timer
+
+//------------------------------------- Prototypes ------------------------------------
+void timer_Arm(Timer *t, uint32_t ms);                  //(neu) stellen, Ablauf nach ms (min. 1)
+void timer_Cancel(Timer *t);                            //löschen, ohne Wirkung wenn nicht gestellt
+bool timer_Armed(const Timer *t);                       //gestellt und noch nicht abgelaufen?
+uint8_t timer_Flag(uint8_t mask);                       //Flags abholen und löschen
+void timer_Tick(void);                                  //1ms-Takt, aus dem Interrupt der HAL
+void timer_Init(void);                                  //Rad leeren (Host: simulierter Reset)
+
+#endif
@@ -0,0 +1,101 @@
+/*
+Titel     : Einstellungen im EEPROM
+--------------------------------------------------------------------------------------
+Funktion  : Siehe config.h. Die Folgenummer hat 8 Bit und wird im Abstand zum
+            bisher besten Eintrag verglichen ((int8_t)(a-b) > 0), der Überlauf
+            von 255 auf 0 stört also nicht, solange der Ring weniger als 128
+            Plätze hat.
+            Ein vorgemerkter Eintrag wird beim Nachholen neu nummeriert, es gilt
+            immer der zuletzt gewünschte Stand.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "config.h"
+#include "crc.h"
+#include "eeprom_map.h"
+#include "inputs.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define CFG_CRC_LEN (sizeof(Config)-1)                  //CRC über alles vor dem CRC-Byte
+
+//------------------------------------- Variablen -------------------------------------
+static Config Stored;                                   //zuletzt geladener bzw. geschriebener Eintrag
+static uint8_t Slot;                                    //dessen Platz im Ring
+static Config Pending;                                  //wartet auf Platz in der Warteschlange
+static bool SavePending=false;
+
+//------------------------------------- Functions -------------------------------------
+static bool cfg_Valid(const Config *c)                  //CRC, Version und Wertebereich prüfen
+{
+  return c->version==CFG_VERSION
+      && crc8((const uint8_t *)c, CFG_CRC_LEN)==c->crc
+      && c->season<=SOMMER
+      && c->onTime!=0;
+}
+
+//-------------------------------------------------------------------------------------------
+bool cfg_Load(Config *cfg)                              //einmal über den Ring, 256 Byte lesen
+{
+  bool found=false;
+  for(uint8_t i=0; i<CFG_SLOTS; i++)
+  {
+    Config c;
+    hal_EeRead(EE_CONFIG+i*sizeof(Config), &c, sizeof(Config));
+    if(!cfg_Valid(&c))                                  //leer (0xFF) oder angefangen
+      continue;
+    if(!found || (int8_t)(c.seq-Stored.seq)>0)          //neuer als der bisher beste?
+    {
+      Stored=c;
+      Slot=i;
+      found=true;
+    }
+  }
+  if(!found)                                            //Ring leer: Vorgaben, der erste
+  {                                                     //Eintrag landet auf Platz 0
+    Stored.seq=0;
+    Stored.version=CFG_VERSION;
+    Stored.season=SOMMER;
+    Stored.onSummer=IN_LV4;
+    Stored.onWinter=IN_LV2;
+    Stored.onTime=ONTIME;
+    Stored.frostTemp=FROSTTEMP;
+    Stored.crc=crc8((const uint8_t *)&Stored, CFG_CRC_LEN);
+    Slot=CFG_SLOTS-1;
+  }
+  *cfg=Stored;
+  SavePending=false;                                    //nichts aus der Zeit vor dem Reset nachholen
+  return found;
+}
+
+//-------------------------------------------------------------------------------------------
+bool cfg_Save(Config *cfg)                              //seq und crc werden hier gesetzt
+{
+  if(cfg->season==Stored.season && cfg->onSummer==Stored.onSummer
+     && cfg->onWinter==Stored.onWinter && cfg->onTime==Stored.onTime
+     && cfg->frostTemp==Stored.frostTemp)
+  {                                                     //unverändert? Dann nichts schreiben,
+    *cfg=Stored;                                        //auch kein älterer Wunsch mehr
+    SavePending=false;
+    return true;
+  }
+  cfg->seq=Stored.seq+1;
+  cfg->version=CFG_VERSION;
+  cfg->crc=crc8((const uint8_t *)cfg, CFG_CRC_LEN);
+  uint8_t next=(Slot+1)%CFG_SLOTS;
+  SavePending=!hal_EeWrite(EE_CONFIG+next*sizeof(Config), cfg, sizeof(Config));
+  if(SavePending)                                       //Warteschlange voll: der neueste Stand
+  {                                                     //geht mit cfg_Flush() hinaus
+    Pending=*cfg;
+    return false;
+  }
+  Stored=*cfg;
+  Slot=next;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+void cfg_Flush(void)                                    //aus task_Control, ohne Vormerkung
+{                                                       //nur ein Vergleich
+  if(SavePending)
+    cfg_Save(&Pending);
+}
@@ -0,0 +1,45 @@
+/*
+Titel     : Prüfsummen
+--------------------------------------------------------------------------------------
+Funktion  : Siehe crc.h. Beide Verfahren schieben nach rechts (LSB zuerst), wie
+            der OneWire-Bus bzw. die serielle Schnittstelle die Bits überträgt.
+--------------------------------------------------------------------------------------
+*/
+#include "crc.h"
+
+//------------------------------------- Functions -------------------------------------
+uint8_t crc8(const uint8_t *data, uint8_t len)          //Polynom x^8+x^5+x^4+1, bitweise,
+{                                                       //spart die 256-Byte-Tabelle
+  uint8_t crc=0;
+  while(len--)
+  {
+    uint8_t b=*data++;
+    for(uint8_t i=0; i<8; i++)
+    {
+      uint8_t mix=(crc^b) & 0x01;
+      crc>>=1;
+      if(mix)
+        crc^=0x8C;
+      b>>=1;
+    }
+  }
+  return crc;
+}
+
+//-------------------------------------------------------------------------------------------
+uint16_t crc16(const uint8_t *data, uint8_t len)        //Polynom x^16+x^15+x^2+1, gespiegelt
+{
+  uint16_t crc=0xFFFF;
+  while(len--)
+  {
+    crc^=*data++;
+    for(uint8_t i=0; i<8; i++)
+    {
+      if(crc & 0x0001)
+        crc=(crc>>1)^0xA001;
+      else
+        crc>>=1;
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,46 @@
+/*
+Titel     : Entprellung mit vertikalen Zählern
+--------------------------------------------------------------------------------------
+Funktion  : siehe debounce.h
+--------------------------------------------------------------------------------------
+*/
+#include "debounce.h"
+
+//------------------------------------- Functions -------------------------------------
+void debounce_Init(Debounce *d, const uint8_t hold[8], uint8_t state)
+{                                                       //Haltezeiten quer auf die Ebenen verteilen
+  for(uint8_t k=0; k<DEBOUNCE_PLANES; k++)
+  {
+    uint8_t plane=0;
+    for(uint8_t i=0; i<8; i++)
+    {
+      uint8_t n=hold[i] ? hold[i]-1 : 0;                //Zähler läuft von hold-1 bis 0
+      if(n & (1<<k))
+        plane|=1<<i;
+    }
+    d->hold[k]=plane;
+    d->count[k]=plane;
+  }
+  d->state=state;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t debounce_Update(Debounce *d, uint8_t sample)    //alle acht Eingänge in einem Durchgang
+{
+  uint8_t delta=sample ^ d->state;                      //Eingänge, die einen Wechsel anzeigen
+  uint8_t nonzero=0;
+  for(uint8_t k=0; k<DEBOUNCE_PLANES; k++)
+    nonzero|=d->count[k];
+
+  uint8_t toggle=delta & ~nonzero;                      //lange genug stabil: umschalten
+  uint8_t dec=delta & nonzero;                          //noch nicht: herunterzählen
+  uint8_t borrow=dec;
+  for(uint8_t k=0; k<DEBOUNCE_PLANES; k++)              //Subtraktion über alle Ebenen,
+  {                                                     //der Übertrag läuft senkrecht
+    uint8_t c=d->count[k] ^ borrow;
+    borrow&=c;                                          //Bit war 0: Übertrag weiterreichen
+    d->count[k]=(c & dec) | (d->hold[k] & ~dec);        //alle anderen Zähler neu laden
+  }
+  d->state^=toggle;
+  return toggle;
+}
@@ -0,0 +1,103 @@
+/*
+Titel     : Ereignisprotokoll im EEPROM
+--------------------------------------------------------------------------------------
+Funktion  : Siehe eventlog.h. Ein neuer Chip ist mit 0xFF gelöscht, alle Plätze
+            haben dann Umlaufbit 1; der erste Umlauf schreibt deshalb mit Bit 0.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "eeprom_map.h"
+#include "eventlog.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define LOG_LAP 0x80                                    //Umlaufbit in Byte 0
+#define LOG_ADDR(slot) (EE_LOG+(uint16_t)(slot)*sizeof(LogRecord))
+
+//------------------------------------- Variablen -------------------------------------
+uint8_t LogLost=0;
+
+static LogRecord Stage[LOG_STAGE];                      //vorgemerkt, noch nicht eingereiht
+static uint8_t StageHead=0;
+static uint8_t StageTail=0;
+static uint8_t Slot=0;                                  //nächster Platz im Ring
+static uint8_t Lap=0;                                   //Umlaufbit des laufenden Umlaufs
+static uint32_t LastMs=0;                               //Zeitpunkt des vorigen Ereignisses
+
+//------------------------------------- Functions -------------------------------------
+void log_Init(void)
+{
+  uint8_t first, code;
+  hal_EeRead(LOG_ADDR(0), &first, 1);
+  Slot=0;
+  Lap=(first & LOG_LAP) ^ LOG_LAP;                      //alle gleich: neuer Umlauf ab Platz 0
+  for(uint8_t i=1; i<LOG_SLOTS; i++)
+  {
+    hal_EeRead(LOG_ADDR(i), &code, 1);
+    if((code ^ first) & LOG_LAP)                        //erster Platz aus dem vorigen Umlauf
+    {
+      Slot=i;
+      Lap=first & LOG_LAP;
+      break;
+    }
+  }
+  StageHead=StageTail=0;
+  LogLost=0;
+  LastMs=hal_Millis();
+}
+
+//-------------------------------------------------------------------------------------------
+void log_Event(uint8_t code, uint8_t data)
+{
+  uint8_t next=(StageHead+1) & (LOG_STAGE-1);
+  if(next==StageTail)                                   //Puffer voll, EEPROM kommt nicht nach
+  {
+    if(LogLost!=0xFF)
+      LogLost++;
+    return;
+  }
+  uint32_t now=hal_Millis();
+  uint32_t delta=(now-LastMs)/1000;
+  LastMs+=delta*1000;                                   //Rest der Sekunde nicht verlieren
+  LogRecord *r=&Stage[StageHead];
+  r->code=code;
+  r->data=data;
+  r->delta=delta>0xFFFF ? 0xFFFF : delta;
+  StageHead=next;
+  log_Flush();                                          //meist ist sofort Platz
+}
+
+//-------------------------------------------------------------------------------------------
+void log_Flush(void)
+{
+  while(StageTail!=StageHead)
+  {
+    LogRecord *r=&Stage[StageTail];
+    uint8_t rest[3]={ r->data, (uint8_t)r->delta, (uint8_t)(r->delta>>8) };
+    uint8_t head=(r->code & ~LOG_LAP) | Lap;
+    uint16_t addr=LOG_ADDR(Slot);
+    if(hal_EeFree()<sizeof(LogRecord))                  //nur einreihen, wenn alle 4 Byte passen,
+      return;                                           //sonst beim nächsten Aufruf weiter
+    hal_EeWrite(addr+1, rest, 3);                       //Platz wird bis dahin nur mehr, beide
+    hal_EeWrite(addr, &head, 1);                        //gelingen also; Byte 0 zuletzt
+    StageTail=(StageTail+1) & (LOG_STAGE-1);
+    if(++Slot==LOG_SLOTS)
+    {
+      Slot=0;
+      Lap^=LOG_LAP;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+bool log_Read(uint8_t age, LogRecord *rec)              //aus dem EEPROM, ohne Sperre der Steuerung
+{
+  if(age>=LOG_SLOTS)
+    return false;
+  uint8_t slot=(Slot+LOG_SLOTS-1-age)%LOG_SLOTS;
+  uint8_t raw[4];
+  hal_EeRead(LOG_ADDR(slot), raw, 4);
+  rec->code=raw[0] & ~LOG_LAP;
+  rec->data=raw[1];
+  rec->delta=raw[2] | (uint16_t)raw[3]<<8;
+  return rec->code!=LOG_EMPTY;
+}
@@ -0,0 +1,555 @@
+/*
+Titel     : Hardware-Abstraktion für den ARDUINO Nano
+--------------------------------------------------------------------------------------
+Funktion  : Umsetzung von hal.h mit Arduino-Core, Timer2, dem TWI-Displaytreiber
+            (lcd_i2c.cpp) und der DallasTemperature-Library.
+            Der Watchdog läuft im Modus "Interrupt, dann Reset": Bleibt die Meldung
+            aller Tasks WDT_MS lang aus, schaltet ISR(WDT_vect) das Relais ab, hält
+            das Zeitrad an und legt den hängenden Task im EEPROM ab. Nach weiteren
+            WDT_MS folgt der Reset, danach sind alle Pins Eingänge (Relais aus).
+            EEPROM-Schreibzugriffe laufen über eine Warteschlange, je Byte ein
+            EE_READY-Interrupt; unveränderte Bytes werden übersprungen. hal_EeRead()
+            hält die Warteschlange an und wartet das laufende Byte bei freigegebenen
+            Interrupts ab, gesperrt wird nur je gelesenem Byte.
+            Mit TELEMETRY sendet hal_UartSend() direkt über die Register des USART0
+            aus einem Ringpuffer, den ISR(USART_UDRE_vect) leert. Serial wird dann
+            nicht benutzt und nicht gelinkt, der Vektor ist frei.
+            Mit MODBUS empfängt ISR(USART_RX_vect) zusätzlich in einen Rahmenpuffer.
+            Jedes Byte startet Timer1 neu; läuft er ab (3,5 Zeichen Pause), ist der
+            Rahmen vollständig und bleibt liegen, bis hal_UartNext() ihn freigibt.
+            Bytes, die währenddessen oder nach einem Empfangsfehler kommen, werden
+            bis zur nächsten Pause verworfen.
+--------------------------------------------------------------------------------------
+*/
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <avr/eeprom.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include "hal.h"
+#include "eeprom_map.h"
+#include "lcd_i2c.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "timer.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define ONSWITCH 10                                     //Input/Pullup: Taster EIN, links
+#define OFFSWITCH 11                                    //Input/Pullup: Taster AUS, rechts
+#define SKIM 2                                          //Input: Skimmerschalter, H-aktiv
+#define LV0 7                                           //Input: Konduktivsonde für Level 0; H-aktiv
+#define LV1 6                                           //Input: Konduktivsonde für Level 1; H-aktiv
+#define LV2 4                                           //Input: Konduktivsonde für Level 2; H-aktiv
+#define LV3 5                                           //Input: Konduktivsonde für Level 3; H-aktiv
+#define LV4 3                                           //Input: Konduktivsonde für Level 4; H-aktiv
+#define REL 12                                          //Output: zum Schalten des Pumpenrelais; H-aktiv
+#define REL_BIT (1<<PB4)                                //REL = PB4, für sbi/cbi im Interrupt
+#define TICKS_1MS 249                                   //OCR2A: 16MHz/64 = 250 Takte je ms
+#define EE_WDT_MARK ((uint8_t *)(EE_DIAG+0))            //WDT_MARK: Watchdog hat ausgelöst, beim Start
+                                                        //von hal_ResetInfo() ausgewertet und gelöscht
+#define EE_WDT_TASK ((uint8_t *)(EE_DIAG+1))            //SchedCurrent beim Auslösen
+#define EE_WDT_COUNT ((uint16_t *)(EE_DIAG+2))          //Anzahl der Watchdog-Resets (0xFFFF = neu)
+#define EE_QUEUE 32                                     //Bytes in der Schreibwarteschlange (Zweierpotenz)
+#define WDT_MARK 0xA5
+#define UART_QUEUE 64                                   //Bytes im Sendepuffer (Zweierpotenz)
+#define RX_SKIP 0                                       //Empfang: bis zur nächsten Pause verwerfen
+#define RX_IDLE 1                                       //Empfang: Pause erkannt, bereit
+#define RX_RECV 2                                       //Empfang: Rahmen läuft
+#define RX_DONE 3                                       //Empfang: Rahmen liegt zur Abholung bereit
+#define T1_START ((1<<WGM12)|(1<<CS11)|(1<<CS10))       //Timer1: CTC, Prescaler 64 (4µs)
+#define ONE_WIRE_BUS 9                                  //OneWire-Bus an D2 (2) bis D12 (12)möglich, D13 nicht!
+
+//--------------------------- fundamentale Systemeinstellungen ------------------------
+static OneWire oneWire(ONE_WIRE_BUS);                   //OneWire-Instanz des OneWire-Busses erzeugen
+static DallasTemperature sensors(&oneWire);             //Übergeben Sie unsere oneWire-Referenz an DS18B20
+static LcdI2C lcd(0x27);                                //LCD an I²C-Adresse 0x27; 16 Zeichen; 2 Zeilen
+                                                        //SDA=A4; SCL=A5 at ARDUINO NANO by default
+static DeviceAddress SensorAddr;                        //ROM-Adresse des Temperatursensors (einmal gesucht)
+static bool SensorFound=false;                          //Flag: SensorAddr ist gültig
+static volatile bool WdtFired=false;                    //ISR(WDT_vect) lief, Reset steht bevor
+static uint8_t ResetFlags __attribute__((section(".noinit"))); //MCUSR beim Start
+static uint16_t EeAddr[EE_QUEUE];                       //Schreibwarteschlange: Adresse
+static uint8_t EeData[EE_QUEUE];                        //und Wert
+static volatile uint8_t EeHead=0;                       //Schreibindex (Hauptprogramm)
+static volatile uint8_t EeTail=0;                       //Leseindex (ISR)
+#if defined(TELEMETRY) || defined(MODBUS)
+static uint8_t UartData[UART_QUEUE];                    //Sendepuffer
+static volatile uint8_t UartHead=0;                     //Schreibindex (Hauptprogramm)
+static volatile uint8_t UartTail=0;                     //Leseindex (ISR)
+#endif
+#ifdef MODBUS
+static uint8_t RxData[UART_FRAME];                      //Empfangspuffer für einen Rahmen
+static volatile uint8_t RxLen=0;                        //empfangene Bytes
+static volatile uint8_t RxState=RX_SKIP;                //RX_xxx
+#endif
+
+static void wdt_Off(void) __attribute__((naked, used, section(".init3")));
+
+static bool find_Sensor(void);
+#ifdef LCD_BENCH
+static void bench_Lcd(void);
+#endif
+
+//------------------------------------- Functions -------------------------------------
+static void wdt_Off(void)                               //vor main(): nach einem Watchdog-Reset
+{                                                       //läuft der Watchdog mit 15ms weiter
+  ResetFlags=MCUSR;                                     //(Optiboot löscht MCUSR schon vorher,
+  MCUSR=0;                                              //dann zählt nur die EEPROM-Marke)
+  wdt_disable();
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Init(void)                                     //Ein-/Ausgänge und Timer2 einrichten
+{
+  pinMode(ONSWITCH, INPUT_PULLUP);                      //Input/Pullup: linker Taster EIN (grün)
+  pinMode(OFFSWITCH, INPUT_PULLUP);                     //Input/Pullup: rechter Taster AUS (rot)
+  pinMode(SKIM, INPUT);                                 //Input SKIMmer-Schalter
+  pinMode(LV0, INPUT);                                  //Input Levelsonde 0
+  pinMode(LV1, INPUT);                                  //Input Levelsonde 1
+  pinMode(LV2, INPUT);                                  //Input Levelsonde 2
+  pinMode(LV3, INPUT);                                  //Input Levelsonde 3
+  pinMode(LV4, INPUT);                                  //Input Levelsonde 4
+  pinMode(REL, OUTPUT);                                 //Schaltet Relais H-aktiv
+                                                        //Timer2 als 1ms-Takt für das Zeitrad
+  TCCR2A=(1<<WGM21);                                    //CTC-Mode, Zähler beginnt in Hardware bei 0
+  OCR2A=TICKS_1MS;                                      //Periode genau 1ms (Quarzgenauigkeit)
+  TCCR2B=(1<<CS22);                                     //Prescaler = 64, Timer2 startet
+  TIMSK2=(1<<OCIE2A);                                   //Compare-Interrupt frei
+                                                        //ungenutzte Einheiten abschalten
+  ADCSRA=0;                                             //ADC (vom Arduino-Core eingeschaltet) aus,
+  ACSR=(1<<ACD);                                        //Analogkomparator aus
+  PRR=(1<<PRADC)|(1<<PRSPI)                             //ADC und SPI ohne Takt
+#ifndef MODBUS
+     |(1<<PRTIM1)                                       //Timer1 nur für die Modbus-Pause
+#endif
+#if !defined(PROFILE) && !defined(LCD_BENCH) && !defined(TELEMETRY) && !defined(MODBUS)
+     |(1<<PRUSART0)                                     //UART nur für Profil, LCD-Messung,
+                                                        //Telemetrie und Modbus
+#endif
+     ;
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t hal_Millis(void)
+{
+  return millis();
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t hal_Micros(void)
+{
+  return micros();
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_Lock(void)
+{
+  uint8_t sreg=SREG;
+  cli();
+  return sreg;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Unlock(uint8_t lock)
+{
+  SREG=lock;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Sleep(void)                                    //SLEEP_MODE_IDLE: nur der CPU-Takt steht,
+{                                                       //Timer0/2, TWI und UART wecken.
+  set_sleep_mode(SLEEP_MODE_IDLE);                      //Spätestens der 1ms-Takt des Zeitrads weckt,
+  sleep_enable();                                       //ein knapp verpasstes Ereignis kostet also
+  sleep_cpu();                                          //höchstens 1ms
+  sleep_disable();
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_WdtInit(void)
+{
+  uint8_t lock=hal_Lock();
+  wdt_reset();
+  WDTCSR=(1<<WDCE)|(1<<WDE);                            //Änderungsfolge, nächster Schreibzugriff
+  WDTCSR=(1<<WDIE)|(1<<WDE)|(1<<WDP2)|(1<<WDP1)|(1<<WDP0);//binnen 4 Takten: 2s, Interrupt und Reset
+  hal_Unlock(lock);
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_WdtKick(void)
+{
+  if(!WdtFired)                                         //nach dem Interrupt ist der Reset beschlossen,
+    wdt_reset();                                        //das Zeitrad steht ja schon
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_ResetInfo(ResetInfo *info)                     //einmal beim Start aufrufen
+{
+  uint16_t count=eeprom_read_word(EE_WDT_COUNT);
+  info->watchdogs=count==0xFFFF ? 0 : count;
+  info->task=SCHED_IDLE;
+  if(eeprom_read_byte(EE_WDT_MARK)==WDT_MARK)           //hat ISR(WDT_vect) vor dem Reset
+  {                                                     //noch eingetragen?
+    info->cause=RESET_WATCHDOG;
+    info->task=eeprom_read_byte(EE_WDT_TASK);
+    eeprom_update_byte(EE_WDT_MARK, 0xFF);              //Marke verbrauchen
+  }
+  else if(ResetFlags & (1<<WDRF))
+    info->cause=RESET_WATCHDOG;
+  else if(ResetFlags & (1<<BORF))
+    info->cause=RESET_BROWNOUT;
+  else if(ResetFlags & (1<<EXTRF))
+    info->cause=RESET_EXTERN;
+  else
+    info->cause=RESET_POWER;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(WDT_vect)                                           //Hauptprogramm hängt, die Hardware ist jetzt
+{                                                       //im Reset-Modus und setzt in WDT_MS zurück
+  PORTB&=~REL_BIT;                                      //Relais sofort sicher aus,
+  TIMSK2=0;                                             //kein Timer des Zeitrads schaltet mehr
+  WdtFired=true;
+  eeprom_update_byte(EE_WDT_TASK, SchedCurrent);        //je Byte 3,4ms, Zeit ist genug
+  uint16_t count=eeprom_read_word(EE_WDT_COUNT);
+  eeprom_update_word(EE_WDT_COUNT, count==0xFFFF ? 1 : count+1);
+  eeprom_update_byte(EE_WDT_MARK, WDT_MARK);            //zuletzt, Eintrag ist damit vollständig
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_EeRead(uint16_t addr, void *data, uint8_t len)
+{
+  uint8_t *p=(uint8_t *)data;
+  bool queued=EECR & (1<<EERIE);
+  EECR&=~(1<<EERIE);                                    //Warteschlange anhalten (cbi, atomar),
+  while(EECR & (1<<EEPE))                               //laufendes Byte (bis 3,4ms) bei
+    ;                                                   //freigegebenen Interrupts abwarten
+  for(uint8_t i=0; i<len; i++)
+  {
+    uint8_t lock=hal_Lock();                            //EEAR nicht mit ISR(WDT_vect) teilen,
+    EEAR=addr+i;                                        //gesperrt nur wenige Takte je Byte
+    EECR|=(1<<EERE);
+    p[i]=EEDR;
+    hal_Unlock(lock);
+  }
+  if(queued)                                            //Warteschlange läuft weiter
+    EECR|=(1<<EERIE);
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_EeFree(void)                                //die ISR leert nur, ein Index als Byte
+{                                                       //ist ohne Sperre stimmig
+  return EE_QUEUE-1-((EeHead-EeTail) & (EE_QUEUE-1));
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_EeWrite(uint16_t addr, const void *data, uint8_t len)
+{
+  const uint8_t *p=(const uint8_t *)data;
+  uint8_t lock=hal_Lock();
+  uint8_t used=(EeHead-EeTail) & (EE_QUEUE-1);
+  if(len>EE_QUEUE-1-used)                               //nur ganz oder gar nicht, ein halber
+  {                                                     //Eintrag fiele ohnehin an der CRC auf
+    hal_Unlock(lock);
+    return false;
+  }
+  uint8_t head=EeHead;
+  for(uint8_t i=0; i<len; i++)
+  {
+    EeAddr[head]=addr+i;
+    EeData[head]=p[i];
+    head=(head+1) & (EE_QUEUE-1);
+  }
+  EeHead=head;
+  EECR|=(1<<EERIE);                                     //Interrupt kommt, sobald das EEPROM frei ist
+  hal_Unlock(lock);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(EE_READY_vect)                                      //EEPROM frei: nächstes geändertes Byte
+{
+  while(EeTail!=EeHead)
+  {
+    uint8_t tail=EeTail;
+    EeTail=(tail+1) & (EE_QUEUE-1);
+    EEAR=EeAddr[tail];
+    EECR|=(1<<EERE);                                    //alten Wert lesen,
+    if(EEDR==EeData[tail])                              //gleiche Bytes kosten keinen Zyklus
+      continue;
+    EEDR=EeData[tail];
+    EECR|=(1<<EEMPE);                                   //Freigabe, EEPE binnen 4 Takten setzen
+    EECR|=(1<<EEPE);                                    //Löschen und Schreiben, 3,4ms
+    return;
+  }
+  EECR&=~(1<<EERIE);                                    //Warteschlange leer
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Relay(bool on)                                 //sbi/cbi, atomar und ohne Pintabelle
+{
+  if(on)
+    PORTB|=REL_BIT;
+  else
+    PORTB&=~REL_BIT;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_RelayState(void)                               //Ausgangsregister statt digitalRead()
+{
+  return PORTB & REL_BIT;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(TIMER2_COMPA_vect)                                  //1ms-Takt des Zeitrads
+{
+  PROF_BEGIN(PROF_TICK);
+  timer_Tick();
+  PROF_END(PROF_TICK);
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_LcdInit(void)
+{
+  lcd.init();                                           //LCD-Display initialisieren
+  lcd.backlight();                                      //Hintergrundlicht an
+#ifdef LCD_BENCH
+  bench_Lcd();                                          //Einreihzeit und Busdurchsatz messen
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_LcdChar(uint8_t location, const uint8_t charmap[8])
+{
+  if(lcd.space()<9)                                     //Adressbefehl und 8 Zeilen, nur ganz
+    return false;                                       //oder gar nicht
+  lcd.createChar(location, charmap);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_LcdWrite(uint8_t col, uint8_t row, const uint8_t *text, uint8_t len)
+{
+  if(lcd.space()<len+1)                                 //passt der Lauf samt Adressbefehl nicht
+    return false;                                       //in den Ringpuffer, nicht warten
+  lcd.setCursor(col, row);
+  lcd.write(text, len);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_LcdErrors(void)
+{
+  return lcd.Errors;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_LcdSync(void)
+{
+  lcd.sync();
+}
+
+//-------------------------------------------------------------------------------------------
+#ifdef PROFILE                                          //Serial belegt 157 Byte RAM und
+void hal_SerialInit(void)                               //zwei Interruptvektoren, nur bei Bedarf
+{
+  Serial.begin(115200);
+}
+
+//-------------------------------------------------------------------------------------------
+int16_t hal_SerialRead(void)
+{
+  return Serial.read();
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_SerialWrite(const char *text)
+{
+  Serial.print(text);
+}
+#endif
+
+//-------------------------------------------------------------------------------------------
+#if defined(TELEMETRY) || defined(MODBUS)
+void hal_UartInit(uint32_t baud, bool parity)           //U2X0: 115200 Baud mit 2,1% Abweichung
+{                                                       //wie im Arduino-Core, 19200 mit 0,2%
+  UCSR0A=(1<<U2X0);
+  UBRR0=(F_CPU/8+baud/2)/baud-1;
+  UCSR0C=(parity ? (1<<UPM01) : 0)|(1<<UCSZ01)|(1<<UCSZ00);
+#ifdef MODBUS
+  uint32_t pause=baud>19200 ? 1750 : 38500000UL/baud;   //3,5 Zeichen à 11 Bit in µs, über 19200
+  TCCR1A=0;                                             //Baud fest 1750µs (Modbus-Spezifikation)
+  TCCR1B=0;
+  OCR1A=pause/4-1;
+  TIMSK1=(1<<OCIE1A);
+  RxState=RX_SKIP;                                      //erst nach einer Pause annehmen
+  TCNT1=0;
+  TCCR1B=T1_START;
+  UCSR0B=(1<<TXEN0)|(1<<RXEN0)|(1<<RXCIE0);
+#else
+  UCSR0B=(1<<TXEN0);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_UartSend(const uint8_t *data, uint8_t len)
+{
+  uint8_t lock=hal_Lock();
+  uint8_t used=(UartHead-UartTail) & (UART_QUEUE-1);
+  if(len>UART_QUEUE-1-used)                             //nur ganze Rahmen, ein halber würde
+  {                                                     //beim Empfänger den nächsten verderben
+    hal_Unlock(lock);
+    return false;
+  }
+  uint8_t head=UartHead;
+  for(uint8_t i=0; i<len; i++)
+  {
+    UartData[head]=data[i];
+    head=(head+1) & (UART_QUEUE-1);
+  }
+  UartHead=head;
+  UCSR0B|=(1<<UDRIE0);                                  //Interrupt kommt, sobald UDR0 frei ist
+  hal_Unlock(lock);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(USART_UDRE_vect)                                    //Senderegister frei: nächstes Byte
+{
+  uint8_t tail=UartTail;
+  UDR0=UartData[tail];
+  tail=(tail+1) & (UART_QUEUE-1);
+  UartTail=tail;
+  if(tail==UartHead)                                    //Puffer leer
+    UCSR0B&=~(1<<UDRIE0);
+}
+#endif
+
+#ifdef MODBUS
+//-------------------------------------------------------------------------------------------
+ISR(USART_RX_vect)                                      //ein Byte empfangen
+{
+  uint8_t error=UCSR0A & ((1<<FE0)|(1<<DOR0)|(1<<UPE0));//vor UDR0 lesen
+  uint8_t b=UDR0;
+  TCNT1=0;                                              //Pause neu messen
+  TCCR1B=T1_START;
+  if(RxState==RX_IDLE)                                  //erstes Byte nach der Pause
+  {
+    RxLen=0;
+    RxState=RX_RECV;
+  }
+  if(RxState!=RX_RECV)                                  //voriger Rahmen noch nicht abgeholt
+    return;                                             //oder Rest eines gestörten: verwerfen
+  if(error || RxLen>=UART_FRAME)                        //gestört oder zu lang, bis zur
+  {                                                     //nächsten Pause verwerfen
+    RxState=RX_SKIP;
+    return;
+  }
+  RxData[RxLen++]=b;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(TIMER1_COMPA_vect)                                  //3,5 Zeichen Ruhe auf der Leitung
+{
+  TCCR1B=0;                                             //Timer anhalten bis zum nächsten Byte
+  if(RxState==RX_RECV)
+    RxState=RX_DONE;
+  else if(RxState==RX_SKIP)
+    RxState=RX_IDLE;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_UartFrame(const uint8_t **data)
+{
+  if(RxState!=RX_DONE)
+    return 0;
+  *data=RxData;
+  return RxLen;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_UartNext(void)
+{
+  uint8_t lock=hal_Lock();
+  RxState=TCCR1B ? RX_SKIP : RX_IDLE;                   //läuft gerade ein Rahmen ein, dessen
+  hal_Unlock(lock);                                     //Rest verwerfen
+}
+#endif
+
+//-------------------------------------------------------------------------------------------
+void hal_TempInit(void)
+{
+  sensors.begin();                                      //Startup Sensor-Library
+  sensors.setWaitForConversion(false);                  //requestTemperatures() nicht blockieren lassen,
+                                                        //das Warten übernimmt get_Temp()
+  find_Sensor();                                        //Sensoradresse einmalig ermitteln
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_TempStart(void)
+{
+  sensors.requestTemperatures();                        //Wandlung auf allen Geräten am Bus anstoßen
+}
+
+//-------------------------------------------------------------------------------------------
+uint16_t hal_TempConvTime(void)
+{
+  return sensors.millisToWaitForConversion();
+}
+
+//-------------------------------------------------------------------------------------------
+int16_t hal_TempRead(void)                              //direkt über die gespeicherte Adresse lesen,
+{                                                       //keine Bussuche bei jedem Zugriff
+  int32_t raw=DEVICE_DISCONNECTED_RAW;
+  if(SensorFound)
+  {
+    raw=sensors.getTemp(SensorAddr);                    //Scratchpad lesen, CRC und Präsenz werden geprüft
+  }
+  if(raw<=DEVICE_DISCONNECTED_RAW)                      //Lesefehler (oder Fehlercode unter -55°C)?
+  {                                                     //ja, dann Bus neu durchsuchen, vielleicht
+    find_Sensor();                                      //wurde der Sensor getauscht
+    return TEMP_NONE;
+  }
+  return raw;
+}
+
+//-------------------------------------------------------------------------------------------
+static bool find_Sensor(void)                           //ersten gültigen Temperatursensor am Bus suchen
+{                                                       //und seine ROM-Adresse in SensorAddr ablegen
+  SensorFound=false;
+  oneWire.reset_search();                               //Suche von vorn beginnen
+  while (oneWire.search(SensorAddr))                    //alle Geräte am Bus durchgehen
+  {
+    if (sensors.validAddress(SensorAddr) && sensors.validFamily(SensorAddr))
+    {                                                   //CRC der Adresse korrekt und DS18x20-Familie?
+      SensorFound=true;                                 //ja, dann Adresse behalten
+      break;
+    }
+  }
+  return SensorFound;
+}
+
+//-------------------------------------------------------------------------------------------
+#ifdef LCD_BENCH
+static void bench_Lcd(void)                             //Einreihzeit (CPU) und Busdurchsatz messen,
+{                                                       //Ausgabe über die serielle Schnittstelle
+  static const uint8_t text[16]={'0','1','2','3','4','5','6','7',
+                                 '8','9','A','B','C','D','E','F'};
+  Serial.begin(115200);
+  lcd.sync();
+  uint32_t start=micros();
+  lcd.setCursor(0, 1);                                  //eine Zeile, passt in den Ringpuffer
+  lcd.write(text, sizeof(text));
+  uint32_t queued=micros()-start;                       //Zeit bis write() zurückkehrt
+  lcd.sync();
+  uint32_t sent=micros()-start;                         //Zeit bis das letzte Byte draußen ist
+  Serial.print("LCD einreihen: ");
+  Serial.print(queued);
+  Serial.println(" us/Zeile");
+  Serial.print("LCD Bus:       ");
+  Serial.print((uint32_t)sizeof(text)*1000000UL/sent);
+  Serial.println(" Zeichen/s");
+}
+#endif
+#endif
@@ -0,0 +1,390 @@
+/*
+Titel     : Hardware-Abstraktion für den Host (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Umsetzung von hal.h und inputs.h ohne Hardware, siehe hal_native.h.
+--------------------------------------------------------------------------------------
+*/
+#ifndef ARDUINO
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "eeprom_map.h"
+#include "inputs.h"
+#include "scheduler.h"
+#include "sim.h"
+#include "timer.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define SIM_COLS 16                                     //Zeichen je Displayzeile
+#define SIM_ROWS 2                                      //Displayzeilen
+#define TICK_US 1000                                    //Periode des Zeitradtakts (wie Timer2)
+                                                        //Wachzeiten des Nano je Vorgang in µs,
+                                                        //Richtwerte, mit bench/simbench.c nachmessen:
+#define AWAKE_TICK 20                                   //Timer0/2-ISR samt Durchlauf von loop()
+#define AWAKE_CHAR 25                                   //Zeichen einreihen, vier TWI-Interrupts
+#define AWAKE_TEMP_START 1200                           //OneWire: Reset, Skip ROM, Convert T
+#define AWAKE_TEMP_READ 11000                           //OneWire: Reset, Match ROM, Scratchpad
+#define AWAKE_TEMP_INIT 15000                           //OneWire: Suche nach dem Sensor
+#define AWAKE_UART 3                                    //Byte senden, ein UDRE-Interrupt
+
+//------------------------------------- Variablen -------------------------------------
+int16_t SimTempRaw=20*TEMP_RAW_PER_C;                   //20°C, frostfrei
+uint32_t SimLcdChars=0;
+double SimAwakeUs=0;
+double SimConvUs=0;
+bool SimSleep=false;
+bool SimHang=false;
+uint32_t SimEeWrites[EE_SIZE];
+FILE *SimUart=NULL;
+bool SimUartHex=false;
+uint8_t SimEeFree=0xFF;
+
+static uint64_t Now=0;                                  //virtuelle Zeit in µs
+static uint8_t RxData[UART_FRAME];                      //empfangener Rahmen (sim_UartFrame)
+static uint8_t RxLen=0;                                 //dessen Länge, 0 = keiner
+static bool Relay=false;                                //Schaltzustand des Relaisausgangs
+static uint64_t TickNext=TICK_US;                       //Zeitpunkt des nächsten Zeitradtakts
+static bool WdtOn=false;                                //Watchdog gestartet
+static bool WdtFired=false;                             //Interrupt lief, Reset steht bevor
+static uint32_t WdtLeft=0;                              //ms bis zum nächsten Ablauf
+static ResetInfo Diag={ RESET_POWER, SCHED_IDLE, 0 };   //statt EEPROM, überlebt sim_Reset()
+static bool DiagMark=false;
+static bool TickStop=false;                             //Zeitrad vom Watchdog angehalten
+static uint8_t Eeprom[EE_SIZE];                         //Inhalt, überlebt sim_Reset()
+static bool EepromErased=false;
+static uint8_t Pins=0;                                  //aktuelles Eingangsabbild
+static uint8_t LcdErrors=0;
+static char Lcd[SIM_ROWS][SIM_COLS+1];                  //Displayinhalt, je Zeile nullterminiert
+
+//------------------------------------- Functions -------------------------------------
+void hal_Init(void)                                     //auch nach dem simulierten Reset:
+{                                                       //Ausgänge und Zeitrad wie nach dem Einschalten
+  Relay=false;
+  WdtOn=false;
+  TickStop=false;
+  timer_Init();
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t hal_Millis(void)
+{
+  return Now/1000;
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t hal_Micros(void)
+{
+  return Now;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_Lock(void)                                  //Host: Interrupts nur in sim_Advance()
+{
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Unlock(uint8_t lock)
+{
+  (void)lock;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Sleep(void)                                    //Host: nur vermerken, sim_Run() rechnet
+{                                                       //den Zeitsprung dann als Schlaf
+  SimSleep=true;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_WdtInit(void)
+{
+  WdtOn=true;
+  WdtFired=false;
+  WdtLeft=WDT_MS;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_WdtKick(void)
+{
+  if(!WdtFired)
+    WdtLeft=WDT_MS;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_ResetInfo(ResetInfo *info)
+{
+  *info=Diag;
+  if(!DiagMark)
+  {
+    info->cause=RESET_POWER;
+    info->task=SCHED_IDLE;
+  }
+  DiagMark=false;
+}
+
+//-------------------------------------------------------------------------------------------
+static void wdt_Expire(void)                            //Ablauf des Watchdogs
+{
+  if(!WdtFired)                                         //erster Ablauf: wie ISR(WDT_vect)
+  {
+    hal_Relay(false);
+    TickStop=true;
+    WdtFired=true;
+    Diag.cause=RESET_WATCHDOG;
+    Diag.task=SchedCurrent;
+    Diag.watchdogs++;
+    DiagMark=true;
+    WdtLeft=WDT_MS;
+    sim_WdtEvent(false);
+  }
+  else                                                  //zweiter Ablauf: Reset
+  {
+    sim_WdtEvent(true);
+    sim_Reset();                                        //kehrt nicht zurück
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void ee_Erase(void)                              //neuer Chip: alles 0xFF
+{
+  if(!EepromErased)
+  {
+    memset(Eeprom, 0xFF, sizeof(Eeprom));
+    EepromErased=true;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_EeRead(uint16_t addr, void *data, uint8_t len)
+{
+  ee_Erase();
+  if(addr+len<=EE_SIZE)
+    memcpy(data, &Eeprom[addr], len);
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_EeFree(void)                                //Host: schreibt sofort, voll nur,
+{                                                       //wenn ein Test es mit SimEeFree vorgibt
+  return SimEeFree;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_EeWrite(uint16_t addr, const void *data, uint8_t len)
+{                                                       //Host: sofort schreiben, Zyklen zählen
+  const uint8_t *p=(const uint8_t *)data;
+  if(len>SimEeFree)                                     //ganz oder gar nicht, wie auf dem Nano
+    return false;
+  ee_Erase();
+  for(uint8_t i=0; i<len && addr+i<EE_SIZE; i++)
+  {
+    if(Eeprom[addr+i]!=p[i])                            //wie die ISR: gleiche Bytes überspringen
+    {
+      Eeprom[addr+i]=p[i];
+      SimEeWrites[addr+i]++;
+    }
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_Relay(bool on)
+{
+  Relay=on;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_RelayState(void)
+{
+  return Relay;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_LcdInit(void)
+{
+  for(uint8_t r=0; r<SIM_ROWS; r++)
+  {
+    for(uint8_t c=0; c<SIM_COLS; c++)
+      Lcd[r][c]=' ';
+    Lcd[r][SIM_COLS]=0;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_LcdChar(uint8_t location, const uint8_t charmap[8])
+{
+  (void)location;
+  (void)charmap;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_LcdWrite(uint8_t col, uint8_t row, const uint8_t *text, uint8_t len)
+{
+  for(uint8_t i=0; i<len && col+i<SIM_COLS && row<SIM_ROWS; i++)
+  {
+    uint8_t ch=text[i];
+    Lcd[row][col+i]=ch<8 ? '0'+ch : (ch<0x80 ? ch : '#');
+  }                                                     //Sonderzeichen lesbar, Rest als '#'
+  SimLcdChars+=len;
+  SimAwakeUs+=len*AWAKE_CHAR;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_LcdErrors(void)
+{
+  return LcdErrors;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_LcdSync(void)
+{
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_SerialInit(void)
+{
+}
+
+//-------------------------------------------------------------------------------------------
+int16_t hal_SerialRead(void)                            //Host: keine Kommandos
+{
+  return -1;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_SerialWrite(const char *text)                  //Host: Ausgabe auf stdout
+{
+  fputs(text, stdout);
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_UartInit(uint32_t baud, bool parity)
+{
+  (void)baud;
+  (void)parity;
+  RxLen=0;
+}
+
+//-------------------------------------------------------------------------------------------
+bool hal_UartSend(const uint8_t *data, uint8_t len)     //Host: Bytes in die Datei von -u
+{
+  SimAwakeUs+=len*AWAKE_UART;
+  if(SimUartHex)                                        //Modbus: Antwort lesbar ausgeben
+  {
+    printf("Modbus:       %10.3f s  >", Now/1e6);
+    for(uint8_t i=0; i<len; i++)
+      printf(" %02X", data[i]);
+    printf("\n");
+  }
+  else if(SimUart)
+    fwrite(data, 1, len, SimUart);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t hal_UartFrame(const uint8_t **data)
+{
+  *data=RxData;
+  return RxLen;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_UartNext(void)
+{
+  RxLen=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_UartFrame(const uint8_t *data, uint8_t len)    //Rahmen samt Pause danach, ein noch
+{                                                       //nicht abgeholter wird überschrieben
+  if(len>UART_FRAME)
+    len=UART_FRAME;
+  memcpy(RxData, data, len);
+  RxLen=len;
+  SimAwakeUs+=len*AWAKE_UART;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_TempInit(void)
+{
+  SimAwakeUs+=AWAKE_TEMP_INIT;
+}
+
+//-------------------------------------------------------------------------------------------
+void hal_TempStart(void)
+{
+  SimAwakeUs+=AWAKE_TEMP_START;
+  SimConvUs+=hal_TempConvTime()*1000.0;
+}
+
+//-------------------------------------------------------------------------------------------
+uint16_t hal_TempConvTime(void)
+{
+  return 750;                                           //DS18B20 bei 12 Bit
+}
+
+//-------------------------------------------------------------------------------------------
+int16_t hal_TempRead(void)
+{
+  if(SimHang)                                           //simulierter Hänger im 1-Wire-Code
+  {
+    SimHang=false;
+    sim_Stall();
+  }
+  SimAwakeUs+=AWAKE_TEMP_READ;
+  return SimTempRaw;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t read_Inputs(void)
+{
+  return Pins;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_SetInputs(uint8_t state)
+{
+  Pins=state;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_Advance(uint32_t us)                           //Zeit vorstellen, dabei fällige
+{                                                       //Zeitradtakte wie die ISR ausführen
+  uint64_t end=Now+us;
+  while(TickNext<=end)
+  {
+    Now=TickNext;
+    TickNext+=TICK_US;
+    if(!TickStop)
+    {
+      timer_Tick();
+      SimAwakeUs+=AWAKE_TICK;
+    }
+    if(WdtOn && --WdtLeft==0)
+      wdt_Expire();
+  }
+  Now=end;
+}
+
+//-------------------------------------------------------------------------------------------
+double sim_Time(void)
+{
+  return Now/1e6;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_EeErase(void)
+{
+  EepromErased=false;
+  ee_Erase();
+}
+
+//-------------------------------------------------------------------------------------------
+const char *sim_LcdLine(uint8_t row)
+{
+  return Lcd[row<SIM_ROWS ? row : 0];
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+Titel     : Zulaufschätzung und vorausschauendes Abpumpen
+--------------------------------------------------------------------------------------
+Funktion  : Siehe inflow.h. Zwischen zwei Sonden k-1 und k gilt
+              Rate = (H[k]-H[k-1]) * 3600000 / dt            in mm/h
+              Überlauf nach (TANK_DEPTH-H[k]) * 3600000 / Rate  in ms
+            Alle Produkte bleiben unter 2^32 (Höhen bis 1000mm). Ein neuer
+            Messwert geht mit 3/4 ein, der vorige mit 1/4; damit folgt die
+            Schätzung einem einsetzenden Wolkenbruch schon nach einem Abschnitt.
+            Ein neuer Anstieg beginnt ohne den alten Wert.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "inflow.h"
+#include "inputs.h"
+#include "tank.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define MS_PER_H 3600000UL
+#define PROBES 6                                        //LV0..LV4 und SKIM, wie IN_xxx Bit 0..5
+
+//------------------------------------- Variablen -------------------------------------
+uint32_t InflowRate=0;
+
+static const uint16_t Height[PROBES+1]=                 //Höhen in mm, zuletzt der Überlauf
+  { PROBE_LV0, PROBE_LV1, PROBE_LV2, PROBE_LV3, PROBE_LV4, PROBE_SKIM, TANK_DEPTH };
+static uint8_t Last;                                    //Sonden bei der letzten Abtastung
+static bool LastRelay;                                  //Relais bei der letzten Abtastung
+static int8_t Probe=-1;                                 //zuletzt nass gewordene Sonde, -1 = keine
+static uint32_t ProbeAt;                                //Zeitpunkt dazu in ms
+static bool Blend=false;                                //InflowRate stammt aus demselben Anstieg
+static bool Armed=false;                                //Alarm ab AlarmAt
+static uint32_t AlarmAt;
+
+//------------------------------------- Functions -------------------------------------
+static void reset(void)                                 //Anstieg zu Ende, InflowRate bleibt
+{                                                       //als letzter Messwert lesbar
+  Probe=-1;
+  Blend=false;
+  Armed=false;
+}
+
+//-------------------------------------------------------------------------------------------
+static void rise(uint8_t k, uint32_t now)               //Sonde k ist nass geworden
+{
+  if(k>0 && Probe==k-1)                                 //Abschnitt unter k vollständig gemessen,
+                                                        //LV0 hat keinen darunter (Probe -1)
+  {
+    uint32_t dt=now-ProbeAt;
+    if(dt==0)
+      dt=1;
+    uint32_t rate=(uint32_t)(Height[k]-Height[k-1])*MS_PER_H/dt;
+    InflowRate=Blend ? (3*rate+InflowRate)>>2 : rate;
+    Blend=true;
+    Armed=false;
+#if INFLOW_MARGIN
+    if(InflowRate)                                      //Alarm nur, wenn der Überlauf noch vor der
+    {                                                   //nächsten Sonde in die Reserve fällt
+      uint32_t next=(uint32_t)(TANK_DEPTH-Height[k+1])*MS_PER_H/InflowRate;
+      if(next<INFLOW_MARGIN)
+      {
+        uint32_t over=(uint32_t)(TANK_DEPTH-Height[k])*MS_PER_H/InflowRate;
+        AlarmAt=now+(over>INFLOW_MARGIN ? over-INFLOW_MARGIN : 0);
+        Armed=true;
+      }
+    }
+#endif
+  }
+  Probe=k;
+  ProbeAt=now;
+}
+
+//-------------------------------------------------------------------------------------------
+void inflow_Init(uint8_t inputs)
+{
+  Last=inputs & (IN_LEVELS|IN_SKIM);
+  LastRelay=hal_RelayState();
+  InflowRate=0;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------
+void inflow_Update(uint8_t inputs, bool relay)          //task_Control (10ms), ohne Wechsel
+{                                                       //nur zwei Vergleiche
+  uint8_t probes=inputs & (IN_LEVELS|IN_SKIM);
+  uint8_t changed=probes^Last;
+  if(relay!=LastRelay)                                  //Pumpe an oder aus: Steigung neu messen
+  {
+    LastRelay=relay;
+    reset();
+  }
+  if(!changed)
+    return;
+  Last=probes;
+  if(changed & ~probes)                                 //eine Sonde trocken: Pegel fällt
+  {                                                     //oder Wellenschlag
+    reset();
+    return;
+  }
+  uint8_t k=PROBES-1;                                   //höchste neu benetzte Sonde
+  while(!(changed & (1<<k)))
+    k--;
+  rise(k, hal_Millis());
+}
+
+//-------------------------------------------------------------------------------------------
+bool inflow_Alarm(void)
+{
+  return Armed && (int32_t)(hal_Millis()-AlarmAt)>=0;
+}
+
+//-------------------------------------------------------------------------------------------
+uint16_t inflow_Liters(void)                            //mm/h mal Grundfläche (l je m Pegel)
+{
+  uint32_t l=InflowRate*TANK_AREA/1000;
+  return l>0xFFFF ? 0xFFFF : l;
+}
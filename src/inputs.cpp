@@ -0,0 +1,33 @@
+/*
+Titel     : Eingangsabbild
+--------------------------------------------------------------------------------------
+Funktion  : siehe inputs.h
+--------------------------------------------------------------------------------------
+*/
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "inputs.h"
+
+//------------------------------------- Functions -------------------------------------
+uint8_t read_Inputs(void)                               //beide Ports direkt nacheinander lesen
+{                                                       //und in IN_xxx-Bits umsortieren
+  uint8_t d, b;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)                     //keine ISR zwischen den zwei Lesezugriffen
+  {
+    d=PIND;
+    b=PINB;
+  }
+  uint8_t in=0;
+  if(d & (1<<PD7)) in|=IN_LV0;
+  if(d & (1<<PD6)) in|=IN_LV1;
+  if(d & (1<<PD4)) in|=IN_LV2;
+  if(d & (1<<PD5)) in|=IN_LV3;
+  if(d & (1<<PD3)) in|=IN_LV4;
+  if(d & (1<<PD2)) in|=IN_SKIM;
+  if(!(b & (1<<PB2))) in|=IN_ON;                        //Taster L-aktiv mit Pullup
+  if(!(b & (1<<PB3))) in|=IN_OFF;
+  return in;
+}
+
+#endif
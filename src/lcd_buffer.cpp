@@ -0,0 +1,135 @@
+/*
+Titel     : Bildspeicher für das LCD
+--------------------------------------------------------------------------------------
+Funktion  : siehe lcd_buffer.h
+--------------------------------------------------------------------------------------
+*/
+#include "lcd_buffer.h"
+#include <string.h>
+#include "hal.h"
+
+//------------------------------------- Functions -------------------------------------
+LcdBuffer::LcdBuffer()
+{
+  init();
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdBuffer::init(void)                              //Puffer entspricht dem frisch
+{                                                       //initialisierten (leeren) Display
+  memset(Cells, ' ', sizeof(Cells));
+  memset(Dirty, 0, sizeof(Dirty));
+  Col=0;
+  Row=0;
+  Errors=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdBuffer::setCursor(uint8_t col, uint8_t row)     //Schreibposition setzen
+{
+  Col=col;
+  Row=row<LCD_ROWS ? row : LCD_ROWS-1;
+}
+
+//-------------------------------------------------------------------------------------------
+size_t LcdBuffer::write(uint8_t value)                  //Zeichen an Schreibposition ablegen
+{
+  if(Col>=LCD_COLS)                                     //rechts außerhalb wird abgeschnitten
+    return 0;
+  if(Cells[Row][Col]!=value)                            //nur echte Änderungen markieren
+  {
+    Cells[Row][Col]=value;
+    Dirty[Row]|=(uint16_t)1<<Col;
+  }
+  Col++;                                                //wie beim HD44780 weiterrücken
+  return 1;
+}
+
+//-------------------------------------------------------------------------------------------
+size_t LcdBuffer::print(const char *text)               //Zeichenkette ablegen
+{
+  size_t n=0;
+  while(*text)
+    n+=write((uint8_t)*text++);
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------
+size_t LcdBuffer::print(int value)                      //Ganzzahl dezimal ablegen
+{
+  char digits[6];                                       //-32768..32767
+  uint8_t i=0;
+  size_t n=0;
+  unsigned int u=value;
+  if(value<0)
+  {
+    n+=write('-');
+    u=-(unsigned int)value;
+  }
+  do
+  {
+    digits[i++]='0'+u%10;
+    u/=10;
+  } while(u);
+  while(i)
+    n+=write(digits[--i]);
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdBuffer::clear(void)                             //Puffer löschen, ohne LCD-Befehl
+{
+  for(uint8_t r=0; r<LCD_ROWS; r++)
+  {
+    setCursor(0, r);
+    for(uint8_t c=0; c<LCD_COLS; c++)
+      write(' ');
+  }
+  setCursor(0, 0);
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdBuffer::invalidate(void)                        //gesamten Inhalt neu übertragen
+{
+  for(uint8_t r=0; r<LCD_ROWS; r++)
+    Dirty[r]=(uint16_t)((1UL<<LCD_COLS)-1);
+}
+
+//-------------------------------------------------------------------------------------------
+bool LcdBuffer::lost(void)                              //hat der Bus Daten verworfen?
+{
+  if(hal_LcdErrors()==Errors)
+    return false;
+  Errors=hal_LcdErrors();                               //ja, dann ist der Displayinhalt
+  invalidate();                                         //unbekannt, alles neu senden
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdBuffer::flush(void)                             //geänderte Zellen übertragen
+{
+  lost();
+  for(uint8_t r=0; r<LCD_ROWS; r++)
+  {
+    uint16_t dirty=Dirty[r];
+    uint8_t c=0;
+    while(dirty)                                        //solange Zellen dieser Zeile offen sind
+    {
+      while(!(dirty & 1))                               //bis zur nächsten geänderten Zelle
+      {
+        dirty>>=1;
+        c++;
+      }
+      uint8_t start=c;
+      while(dirty & 1)                                  //Länge des zusammenhängenden Laufs
+      {
+        dirty>>=1;
+        c++;
+      }
+      uint8_t len=c-start;
+      if(!hal_LcdWrite(start, r, &Cells[r][start], len))
+        return;                                         //kein Platz mehr, beim nächsten Aufruf weiter
+      Dirty[r]&=~(uint16_t)(((1UL<<len)-1)<<start);
+    }
+  }
+}
@@ -0,0 +1,291 @@
+/*
+Titel     : HD44780-Treiber über PCF8574 (I²C)
+--------------------------------------------------------------------------------------
+Funktion  : siehe lcd_i2c.h
+
+            Ein Zeichen kostet 4 Bytes auf dem Bus (je Nibble Enable high und low, das
+            Vorbyte nur bei Wechsel von RS), bei 100kHz also ~0,36ms bzw. ~2700 Zeichen/s.
+            Das ist aus dem Bustakt gerechnet, nicht gemessen.
+            Die CPU ist davon nur mit einer kurzen ISR je Byte belastet.
+            Mit -DLCD_BENCH misst hal_LcdInit() Einreihzeit und Busdurchsatz auf der Hardware.
+--------------------------------------------------------------------------------------
+*/
+#ifdef ARDUINO
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "lcd_i2c.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define Q_DATA 0x01                                     //Eintrag: Zeichen (RS=1)
+#define Q_CMD 0x00                                      //Eintrag: Befehl (RS=0)
+#define Q_NIBBLE 0x02                                   //Eintrag: einzelnes Nibble (Initialisierung)
+#define Q_FILL 0x04                                     //Eintrag: Value Füllbytes als Wartezeit
+
+#define TW_START 0x08                                   //TWI-Statuscodes Master Transmitter
+#define TW_REP_START 0x10
+#define TW_MT_SLA_ACK 0x18
+#define TW_MT_DATA_ACK 0x28
+
+#define TWCR_GO ((1<<TWINT)|(1<<TWEN)|(1<<TWIE))        //nächsten Busschritt ausführen
+#define TWCR_START (TWCR_GO|(1<<TWSTA))
+#define TWCR_STOP ((1<<TWINT)|(1<<TWEN)|(1<<TWSTO))
+#define STOP_WAIT 255                                   //Abfragen von TWSTO, ~80µs bei 16MHz
+
+static LcdI2C *Instance;                                //Display, das die ISR bedient
+
+//------------------------------------- Functions -------------------------------------
+LcdI2C::LcdI2C(uint8_t addr)
+{
+  Addr=addr;
+  Backlight=0;
+  Errors=0;
+  Head=0;
+  Tail=0;
+  Busy=false;
+  SeqLen=0;
+  SeqPos=0;
+  Fill=0;
+  Port=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::init(void)                                 //Initialisierung nach HD44780-Datenblatt,
+{                                                       //Bild 24, wie LiquidCrystal_I2C::begin()
+  Instance=this;
+  PORTC|=(1<<PORTC4)|(1<<PORTC5);                       //interne Pullups an SDA/SCL wie Wire
+  TWSR=0;                                               //Vorteiler 1
+  TWBR=((F_CPU/LCD_I2C_CLOCK)-16)/2;                    //Bustakt einstellen
+  TWCR=(1<<TWEN);
+
+  pause(50000);                                         //>40ms nach Anlegen der Spannung, als
+                                                        //Füllbytes statt delay(): init() kehrt sofort
+                                                        //zurück, die Wartezeit vergeht auf dem Bus.
+                                                        //Dabei gehen alle Ausgänge des PCF8574 low
+
+  push(Q_NIBBLE, 0x30);                                 //dreimal 8-Bit-Modus, dann 4-Bit-Modus
+  pause(4500);
+  push(Q_NIBBLE, 0x30);
+  pause(4500);
+  push(Q_NIBBLE, 0x30);
+  pause(150);
+  push(Q_NIBBLE, 0x20);
+
+  command(LCD_FUNCTIONSET | LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS);
+  command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+  clear();
+  command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+  home();
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::backlight(void)                            //Hintergrundlicht an, wird mit
+{                                                       //dem nächsten Byte wirksam
+  Backlight=LCD_BACKLIGHT;
+  pause(LCD_BYTE_US);
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::clear(void)
+{
+  command(LCD_CLEARDISPLAY);
+  pause(2000);                                          //Befehl braucht 1,52ms
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::home(void)
+{
+  command(LCD_RETURNHOME);
+  pause(2000);                                          //Befehl braucht 1,52ms
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::setCursor(uint8_t col, uint8_t row)
+{
+  static const uint8_t offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+  command(LCD_SETDDRAMADDR | (col + offsets[row & 3]));
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::createChar(uint8_t location, const uint8_t charmap[])
+{                                                       //Sonderzeichen in CGRAM ablegen
+  command(LCD_SETCGRAMADDR | ((location & 7) << 3));
+  write(charmap, 8);
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::command(uint8_t value)
+{
+  push(Q_CMD, value);
+}
+
+//-------------------------------------------------------------------------------------------
+size_t LcdI2C::write(uint8_t value)
+{
+  return push(Q_DATA, value);
+}
+
+//-------------------------------------------------------------------------------------------
+size_t LcdI2C::write(const uint8_t *buffer, size_t size)
+{
+  size_t n=0;
+  while(n<size && push(Q_DATA, buffer[n]))
+    n++;
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t LcdI2C::space(void)                             //freie Einträge im Ringpuffer
+{
+  return (LCD_QUEUE-1)-((Head-Tail) & (LCD_QUEUE-1));
+}
+
+//-------------------------------------------------------------------------------------------
+bool LcdI2C::idle(void)
+{
+  return Head==Tail && !Busy;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::sync(void)                                 //nur für setup() und Messungen
+{
+  while(!idle());
+}
+
+//-------------------------------------------------------------------------------------------
+bool LcdI2C::push(uint8_t ctrl, uint8_t value)          //Eintrag anhängen und Bus anstoßen
+{
+  if(space()==0)                                        //Puffer voll: nicht warten, sondern
+  {                                                     //verwerfen und als Fehler zählen, der
+    uint8_t sreg=SREG;                                  //Bildspeicher überträgt dann alles neu.
+    cli();                                              //Die Aufrufer prüfen vorher space(),
+    Errors++;                                           //das ist also die Ausnahme
+    SREG=sreg;
+    return false;
+  }
+  uint8_t head=Head;
+  Ctrl[head]=ctrl;
+  Value[head]=value;
+  Head=(head+1) & (LCD_QUEUE-1);                        //erst danach für die ISR sichtbar
+  kick();
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::pause(uint16_t us)                         //Wartezeit in Füllbytes umrechnen
+{
+  uint16_t bytes=(us+LCD_BYTE_US-1)/LCD_BYTE_US;
+  while(bytes)
+  {
+    uint8_t n=bytes>255 ? 255 : bytes;
+    push(Q_FILL, n);
+    bytes-=n;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::kick(void)                                 //START senden, wenn der Bus ruht
+{
+  uint8_t sreg=SREG;
+  cli();
+  if(!Busy)                                             //ISR hat Übertragung beendet oder
+  {                                                     //noch nie begonnen
+    uint8_t n=STOP_WAIT;
+    while((TWCR & (1<<TWSTO)) && --n);                  //laufende STOP-Bedingung abwarten (<10µs)
+    if(!n)                                              //hält ein Teilnehmer SCL low, endet sie
+    {                                                   //nie: TWI zurücksetzen und Fehler zählen.
+      Errors++;                                         //Das START unten wartet in der Hardware,
+      TWCR=0;                                           //bis der Bus frei ist; bis dahin bleibt
+      TWCR=(1<<TWEN);                                   //Busy gesetzt, hier wird nie mehr gewartet
+    }
+    Busy=true;
+    TWCR=TWCR_START;
+  }
+  SREG=sreg;
+}
+
+//-------------------------------------------------------------------------------------------
+int16_t LcdI2C::next(void)                              //nächstes Byte für den PCF8574, -1 = fertig
+{
+  while(1)
+  {
+    if(SeqPos<SeqLen)                                   //Portzustände des aktuellen Eintrags
+    {
+      Port=Seq[SeqPos++];
+      return Port | Backlight;
+    }
+    if(Fill)                                            //Wartezeit: Port unverändert ausgeben
+    {
+      Fill--;
+      return Port | Backlight;
+    }
+    uint8_t tail=Tail;
+    if(tail==Head)                                      //Ringpuffer leer
+      return -1;
+
+    uint8_t ctrl=Ctrl[tail];
+    uint8_t value=Value[tail];
+    Tail=(tail+1) & (LCD_QUEUE-1);
+    SeqPos=0;
+    SeqLen=0;
+    if(ctrl & Q_FILL)
+    {
+      Fill=value;
+      continue;
+    }
+    uint8_t mode=ctrl & LCD_RS;
+    uint8_t hi=(value & 0xF0) | mode;
+    if((hi ^ Port) & LCD_RS)                            //RS muss vor der steigenden Flanke
+    {                                                   //von Enable stabil sein
+      Seq[SeqLen++]=hi;
+    }
+    Seq[SeqLen++]=hi | LCD_EN;                          //Enable high, Daten anlegen
+    Seq[SeqLen++]=hi;                                   //Enable low, Display übernimmt
+    if(!(ctrl & Q_NIBBLE))                              //unteres Nibble folgt
+    {
+      uint8_t lo=((value << 4) & 0xF0) | mode;
+      Seq[SeqLen++]=lo | LCD_EN;
+      Seq[SeqLen++]=lo;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void LcdI2C::isr(void)                                  //ein Busschritt je Interrupt
+{
+  int16_t data;
+  switch(TWSR & 0xF8)
+  {
+    case TW_START:                                      //START gesendet: Adresse schreiben
+    case TW_REP_START:
+      TWDR=Addr<<1;
+      TWCR=TWCR_GO;
+      return;
+
+    case TW_MT_SLA_ACK:                                 //Adresse oder Byte quittiert:
+    case TW_MT_DATA_ACK:                                //nächstes Byte senden
+      data=next();
+      if(data>=0)
+      {
+        TWDR=(uint8_t)data;
+        TWCR=TWCR_GO;
+        return;
+      }
+      break;                                            //nichts mehr zu tun: STOP
+
+    default:                                            //NACK, Arbitrierung verloren, Busfehler:
+      Errors++;                                         //Rest verwerfen, der Bildspeicher
+      Tail=Head;                                        //überträgt beim nächsten Mal neu
+      SeqLen=0;
+      Fill=0;
+      break;
+  }
+  TWCR=TWCR_STOP;
+  Busy=false;
+}
+
+//-------------------------------------------------------------------------------------------
+ISR(TWI_vect)
+{
+  Instance->isr();
+}
+#endif
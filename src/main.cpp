@@ -15,43 +15,72 @@ Autor     : c 2025 by Peter Lampe
 
 */
 //------------------------------------- Libraries -------------------------------------
-#include <Arduino.h>
-#include <OneWire.h>
-#include <DallasTemperature.h>
-//#include <Wire.h>
-#include <LiquidCrystal_I2C.h>
+#include "hal.h"
+#include "config.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "lcd_buffer.h"
+#include "inputs.h"
+#include "debounce.h"
+#include "bench.h"
+#include "profile.h"
+#include "eventlog.h"
+#include "telemetry.h"
+#include "modbus.h"
+#include "pump.h"
+#include "inflow.h"
 //--------------------------------------- Defines -------------------------------------
-#if defined(ARDUINO) && ARDUINO >= 100
 #define printByte(args)  write(args);
-#else
-#define printByte(args)  print(args,BYTE);
-#endif
-
-#define ONSWITCH 10                                     //Input/Pullup: Taster EIN, links
-#define OFFSWITCH 11                                    //Input/Pullup: Taster AUS, rechts
-#define SKIM 2                                          //Input: Skimmerschalter, H-aktiv
-#define LV0 7                                           //Input: Konduktivsonde für Level 0; H-aktiv
-#define LV1 6                                           //Input: Konduktivsonde für Level 1; H-aktiv
-#define LV2 4                                           //Input: Konduktivsonde für Level 2; H-aktiv
-#define LV3 5                                           //Input: Konduktivsonde für Level 3; H-aktiv
-#define LV4 3                                           //Input: Konduktivsonde für Level 4; H-aktiv
-#define REL 12                                          //Output: zum Schalten des Pumpenrelais; H-aktiv
+                                                        //Pinbelegung siehe hal_avr.cpp und inputs.h
 #define OFF 0                                           //Schaltzustand "aus"
 #define ON 1                                            //Schaltzustand "ein"
-#define SOMMER 1                                        //Deffinition Jahreszeit 
-#define WINTER 0
-#define FROSTTEMP 2                                     //Umschalttemperatur für Frosterkennung
-#define ONTIME 60                                       //Nachlaufzeit der Pumpe in Sekunden (60)
+                                                        //Jahreszeit, Frostgrenze und Nachlaufzeit
+                                                        //siehe config.h, Werte im EEPROM
+#define RUNON_MS (Cfg.onTime*1000UL)                    //Nachlaufzeit in ms für das Zeitrad
+#define SEASONLOCK 700                                  //Sperrzeit nach Jahreszeitwechsel in ms
+#define INTROTIME 3000                                  //Anzeigedauer des Startbildschirms in ms
+#define TF_INTRO 0x01                                   //TimerFlags: Startbildschirm abgelaufen
+#define GLYPHS 8                                        //Sonderzeichen im CGRAM des Displays
+#define TEMP_INIT 0                                     //Zustand: Sensor noch nicht gesucht
+#define TEMP_REQUEST 1                                  //Zustand: Temperaturwandlung anstoßen
+#define TEMP_WAIT 2                                     //Zustand: auf Ende der Wandlung warten
+#define TEMPPAUSE 9000                                  //Messpause nach jeder Wandlung in ms; Frost
+                                                        //kommt langsam, der DS18B20 zieht beim
+                                                        //Wandeln 1mA. Bei 1s-Takt stiege der
+                                                        //Mittelwert in der Simulation um ~12%
+#define SAMPLETIME 10                                   //Abtastperiode der Entprellung in ms
 
 
 //---------------------------------- globale Variablen --------------------------------
 bool Frost=false;                                       //Flag zur Frost-Erfassung (0=kein Frost, 1=Frost)
-bool Season=SOMMER;                                     //Jahreszeit, mit Sommer initialisieren
-bool Level[5]={0, 0, 0, 0, 0};                          //Feld mit Schaltzuständen KONduktivsensor
+bool SensorFault=false;                                 //Flag: Temperatursensor ausgefallen, Notbetrieb
+Config Cfg;                                             //Einstellungen, beim Start aus dem EEPROM
+bool Season=SOMMER;                                     //Jahreszeit, aus Cfg übernommen
+uint8_t Inputs=0;                                       //entprelltes Eingangsabbild (IN_xxx-Bits),
                                                         //zum Start "Zisterne leer" initialisieren
-uint8_t OnLevel=LV4;                                    //Einschaltlevel (für Sommer initialisiert)
-uint8_t OFFLevel=LV1;                                   //Abschaltlevel, unabhängig von der Jahreszeit
-volatile uint8_t TimeDelay=0;                           //Timer1 Verzögerungszähler in Sekunden                        
+Debounce Filter;                                        //Entprellung aller acht Eingänge
+const uint8_t HoldTime[8]=                              //Haltezeiten in Abtastungen à SAMPLETIME
+{
+  50, 50, 50, 50, 50,                                   //LV0..LV4: 500ms gegen Wellenschlag
+  10,                                                   //SKIM: 100ms
+  3, 3                                                  //ON, OFF: 30ms gegen Tasterprellen
+};
+uint8_t OnLevel=IN_LV4;                                 //Einschaltlevel, aus Cfg übernommen
+uint8_t OFFLevel=IN_LV1;                                //Abschaltlevel, unabhängig von der Jahreszeit
+uint8_t TempState=TEMP_INIT;                            //Zustand der Temperaturerfassung
+int16_t TempRaw=TEMP_NONE;                              //letzter Rohwert des Sensors (1/128°C)
+static void end_RunOn(void);                            //Nachlaufzeit abgelaufen (Interrupt)
+Timer RunOn=TIMER_CALL(end_RunOn);                      //Nachlaufzeit, schaltet im Interrupt ab
+uint32_t RunOnEnd=0;                                    //Ablaufzeitpunkt von RunOn (Telemetrie)
+Timer SeasonLock=TIMER_FLAG(0);                         //Sperre gegen Umspringen der Jahreszeit
+Timer IntroTimer=TIMER_FLAG(TF_INTRO);                  //Anzeigedauer des Startbildschirms
+Timer TempTimer=TIMER_FLAG(0);                          //Wandlungszeit des Temperatursensors
+ResetInfo LastReset;                                    //Ursache des letzten Resets (Diagnose)
+bool LoggedRelay=false;                                 //Relaisstand im Ereignisprotokoll
+uint8_t LoggedInputs=0;                                 //Sonden und Skimmer im Ereignisprotokoll
+#ifdef MODBUS
+uint8_t LogAge=0;                                       //Beginn des Protokollfensters (MB_HR_LOGAGE)
+#endif
 
 uint8_t my1[8] = {0x0,0x4,0x4,0x4,0x4,0x4,0x0};         //Sonderzeichendefinition für Display
 uint8_t my2[8] = {0x0,0x1,0x2,0x4,0x8,0x10,0x0};
@@ -61,58 +90,90 @@ uint8_t my5[8] = {0x1f,0x1f,0x1f,0x1f,0x1f,0x1f,0x1f};
 uint8_t my6[8] = {0x3,0x2,0x2,0x2,0x2,0x2,0x3};
 uint8_t my7[8] = {0x1f,0x0,0x0,0x0,0x0,0x0,0x1f};
 uint8_t my8[8] = {0x18,0x1,0x3,0x7,0x3,0x1,0x18};
+const uint8_t *const Glyphs[GLYPHS]=                    //Reihenfolge = Zeichencode 0..7:
+  { my1, my2, my3, my4, my5, my6, my7, my8 };           //Action-Symbol 1..4, Segment "voll",
+                                                        //Teufe, Segment "leer", Brunnenrand
+uint8_t GlyphsLoaded=GLYPHS;                            //geladene Sonderzeichen, GLYPHS = alle
 
 //------------------------------------- Prototypes ------------------------------------
 void get_Temp (void);                       //Temperatur auslesen, darstellen und Flag setzen
 void show_Intro (void);                     //Anzeige Startbildschirm
+void show_Main (void);                      //statischen Teil des Hauptbildschirms zeichnen
+void show_Temp (void);                      //Temperatur und Frostzustand aus dem letzten Messwert zeigen
 void show_Level(void);                      //Anzeige der Pegelstände im Display
 void move_Wheel(bool action);               //zeigt Aktivitätssymbole für Pumpe an (0=aus; 1=an)
+void task_Control(void);                    //Eingänge entprellen und auswerten
+void eval_Control(void);                    //Taster und Pegel auswerten, Relais schalten
+void log_Control(void);                     //Relais- und Sondenwechsel protokollieren
+void start_RunOn(void);                     //Nachlaufzeit (neu) starten
+bool set_Season(bool season);               //Jahreszeit umschalten, anzeigen und speichern
+void task_Display(void);                    //Pegelanzeige aktualisieren
+void task_Wheel(void);                      //Pumpenanimation weiterschalten
+void task_Temp(void);                       //Temperaturmessung
 
 //--------------------------- fundamentale Systemeinstellungen ------------------------
-#define ONE_WIRE_BUS 9                      //OneWire-Bus an D2 (2) bis D12 (12)möglich, D13 nicht!
-OneWire oneWire(ONE_WIRE_BUS);              //OneWire-Instanz des OneWire-Busses erzeugen
-DallasTemperature sensors(&oneWire);        //Übergeben Sie unsere oneWire-Referenz an DS18B20
-LiquidCrystal_I2C lcd(0x27,20,4);           //LCD an I²C-Adresse 0x27; 16 Zeichen; 2 Zeilen 
-                                            //SDA=A4; SCL=A5 at ARDUINO NANO by default
+LcdBuffer screen;                           //Bildspeicher, alle Ausgaben gehen über ihn
+
+Task Tasks[] =                              //Tasktabelle, Reihenfolge = Priorität
+{                                           //      Funktion      Periode Termin (ms)
+  TASK(task_Control,   10,   10),           //Entprellung (=SAMPLETIME), Taster, Sonden, Relais
+  TASK(pump_Task,    1000, 1000),           //Laufzeit, Tastgrad, Statistik im EEPROM
+  TASK(task_Temp,    1000,  100),           //Temperaturmessung, Wandlung etwa alle 10s
+  TASK(task_Display,  100,  100),           //Pegelanzeige
+  TASK(task_Wheel,    250,  250),           //Pumpenanimation
+  PROF_TASK()                               //Profil seriell ausgeben (nur mit PROFILE)
+  TELE_TASK()                               //Telemetrierahmen senden (nur mit TELEMETRY)
+  MB_TASK()                                 //Modbus-Anfragen beantworten (nur mit MODBUS)
+};
 
                                             //--------------------------------------- Setup ---------------------------------------
-void setup(void)
-{
+void setup(void)                            //Reihenfolge: zuerst Sonden lesen und Relais
+{                                           //schalten, alles Langsame läuft danach im Hintergrund
  // Serial.begin(115200);                     //serial port initialisieren (nur für Debugzwecke)
-  sensors.begin();                          //Startup Sensor-Library
-  lcd.init();                               //LCD-Display initialisieren
-  lcd.backlight();                          //Hintergrundlicht an
-  
-  pinMode(ONSWITCH, INPUT_PULLUP);          //Input/Pullup: linker Taster EIN (grün)
-  pinMode(OFFSWITCH, INPUT_PULLUP);         //Input/Pullup: rechter Taster AUS (rot)
-  pinMode(SKIM, INPUT);                     //Input SKIMmer-Schalter
-  pinMode(LV0, INPUT);                      //Input Levelsonde 0
-  pinMode(LV1, INPUT);                      //Input Levelsonde 1
-  pinMode(LV2, INPUT);                      //Input Levelsonde 2
-  pinMode(LV3, INPUT);                      //Input Levelsonde 3
-  pinMode(LV4, INPUT);                      //Input Levelsonde 4
-  pinMode(REL, OUTPUT);                     //Schaltet Relais H-aktiv
-                                            
-                                            //Initialisierung der Sonderzeichen
-  lcd.createChar(0, my1);                   //Action-Symbol 1       
-  lcd.createChar(1, my2);                   //Action-Symbol 2
-  lcd.createChar(2, my3);                   //Action-Symbol 3
-  lcd.createChar(3, my4);                   //Action-Symbol 4
-  lcd.createChar(4, my5);                   //Brunnensegment "voll"
-  lcd.createChar(5, my6);                   //Brunnenteufe
-  lcd.createChar(6, my7);                   //Brunnensegment "leer"
-  lcd.createChar(7, my8);                   //oberer Brunnenrand
-  lcd.home();
-
-  show_Intro();                             //Eingangsbildschirm anzeigen
-  lcd.printByte(5);                         //"Brunnenboden" statisch anzeigen
-  lcd.setCursor(0, 1);                      //Tastenmenü positionieren
-  lcd.print("On <-- S --> Off");            //und anzeigen
-                                            //Timer1 initialisieren 
-  TCCR1A&=~((1<<WGM11)|(1<<WGM10));         //Normal Mode  
-  TCNT1=0xBDC;                              //Timer1 Preloading für 1s
-  TCCR1B=0;                                 //Timer erst mal anhalten aber ist aber in Bereitschaft
+  hal_Init();                               //Ein-/Ausgänge und 1ms-Takt des Zeitrads einrichten
+  Frost=false;                              //Zustand wie nach dem Einschalten, auch wenn der
+  SensorFault=false;                        //Simulator nach einem Watchdog-Reset setup() mit
+  TempState=TEMP_INIT;                      //den alten Variablen erneut aufruft
+  TempRaw=TEMP_NONE;
+  RunOnEnd=0;
+  GlyphsLoaded=GLYPHS;
+  screen.init();
+  cfg_Load(&Cfg);                           //Einstellungen aus dem EEPROM (256 Byte lesen)
+  pump_Init();                              //Pumpenstatistik aus dem EEPROM (240 Byte lesen)
+  Season=Cfg.season;
+  OnLevel=Season==SOMMER ? Cfg.onSummer : Cfg.onWinter;
+  debounce_Init(&Filter, HoldTime, read_Inputs()); //Entprellung mit dem aktuellen Zustand starten,
+                                            //damit nach dem Reset keine Scheinflanken entstehen
+  Inputs=Filter.state;
+  inflow_Init(Inputs);                      //Zulauf erst ab der nächsten Sonde messen
+  eval_Control();                           //erste Entscheidung sofort, nicht erst nach
+  BENCH_MARK(MARK_DECIDE);                  //Display und Temperatursensor
+  hal_WdtInit();                            //ab jetzt müssen sich alle Tasks melden
+  hal_ResetInfo(&LastReset);                //Ursache des Resets, Watchdog-Marke löschen
+  log_Init();                               //Schreibposition im Protokoll suchen (128 Byte)
+  log_Event(LOG_BOOT, LastReset.cause);
+  if(LastReset.cause==RESET_WATCHDOG)
+    log_Event(LOG_WATCHDOG, LastReset.task);
+  LoggedRelay=false;                        //Relais war beim Reset aus, ein Einschalten
+  LoggedInputs=Inputs & (IN_LEVELS|IN_SKIM); //in eval_Control wird also protokolliert
+#ifdef PROFILE
+  prof_Init();                              //Laufzeitprofil, Ausgabe mit 'p'
+#endif
+#ifdef TELEMETRY
+  tele_Init();                              //UART für die Telemetrie
+#endif
+#ifdef MODBUS
+  mb_Init();                                //UART und Timer1 für Modbus
+  LogAge=0;                                 //Protokollfenster beim jüngsten Eintrag
+#endif
+  hal_LcdInit();                            //LCD-Initialisierung nur einreihen, der Bus
+                                            //arbeitet sie im Interrupt ab
+  show_Intro();                             //Eingangsbildschirm dahinter einreihen, Hauptbildschirm
+                                            //folgt nach Ablauf von IntroTimer in task_Display.
+                                            //Der Temperatursensor wird in task_Temp gesucht
 
+  sched_Init(Tasks, sizeof(Tasks)/sizeof(Tasks[0]));
+                                            //Scheduler mit der Tasktabelle starten
 //while(1);//Debugstop
 //Serial.println("End Setup");
 }
@@ -120,156 +181,505 @@ void setup(void)
 //------------------------------------- Main loop -------------------------------------
 
 void loop(void)
-{                                               //bei jedem Schleifendurchlauf wird immer
-get_Temp();                                     //die Temperatur erfasst
-show_Level();                                   //und die Pegelanzeige vorgenommen
+{
+  BENCH_MARK(MARK_LOOP);                        //Messmarke für bench/simbench.c
+  PROF_LOOP();                                  //Periode von loop() ins Histogramm
+  sched_Run();                                  //fällige Tasks ausführen, jeder nach seiner Periode
+  if(sched_Alive())                             //alle Tasks seit dem letzten Mal zurückgekehrt?
+    hal_WdtKick();                              //dann Watchdog zurücksetzen
+  BENCH_MARK(MARK_LOOP_END);
+  if(sched_Idle())                              //bis zur nächsten Freigabe nichts zu tun?
+    hal_Sleep();                                //dann bis zum nächsten Interrupt schlafen
+}
+
+//------------------------------------- Functions -------------------------------------
+void task_Control(void)                         //Eingänge entprellen und auswerten (SAMPLETIME)
+{
+  debounce_Update(&Filter, read_Inputs());      //eine Abtastung für alle Eingänge
+  Inputs=Filter.state;
+  inflow_Update(Inputs, hal_RelayState());      //Sondenwechsel: Zulauf neu schätzen
+  eval_Control();                               //hält bei anstehendem Pegel auch die
+                                                //Nachlaufzeit frisch
+  log_Control();                                //Relais- und Sondenwechsel protokollieren
+  log_Flush();                                  //Vorgemerktes an die EEPROM-Warteschlange
+  cfg_Flush();
+}
 
+//-------------------------------------------------------------------------------------------
+void log_Control(void)                          //Wechsel gegen den zuletzt protokollierten
+{                                               //Stand; das Relais schalten auch end_RunOn
+  bool relay=hal_RelayState();                  //und get_Temp, daher hier und nicht beim Schalten
+  if(relay!=LoggedRelay)
+  {
+    LoggedRelay=relay;
+    log_Event(relay ? LOG_PUMP_ON : LOG_PUMP_OFF, Pump.source);
+  }
+  uint8_t probes=Inputs & (IN_LEVELS|IN_SKIM);
+  uint8_t changed=probes^LoggedInputs;
+  if(changed & IN_LEVELS)                       //entprellt, Wellenschlag kommt hier nicht an
+    log_Event(LOG_PROBES, probes);
+  if(changed & probes & IN_SKIM)                //nur das Auslösen des Skimmers
+    log_Event(LOG_SKIM, probes);
+  LoggedInputs=probes;
+}
+
+//-------------------------------------------------------------------------------------------
+void eval_Control(void)                         //Taster und Pegel aus Inputs auswerten, Relais schalten
+{
 if (Frost==false)                               //ist Brunnen frostfrei?
   {                                             //ja, dann vollen Betrieb ermöglichen
-    if (!digitalRead(ONSWITCH))                 //EIN-Schalter gedrückt?
+    PROF_BEGIN(PROF_BUTTONS);
+    if ((Inputs & IN_ON) && !SensorFault)       //EIN-Schalter gedrückt (im Notbetrieb gesperrt)?
       {                                         //ja, dann
-        digitalWrite(REL, ON);                  //Relais an und schon mal den 
-        TimeDelay=0;                            //Verzögerungszzähler reseten für Abschaltung
-        
+        pump_Set(ON, PUMP_BUTTON);              //Relais an und eine laufende
+        if(timer_Armed(&RunOn))                 //Nachlaufzeit für die Abschaltung
+          start_RunOn();                        //neu starten
       }
 
-    if (!digitalRead(OFFSWITCH))                //Aus-Schalter gedrückt?
+    if (Inputs & IN_OFF)                        //Aus-Schalter gedrückt?
       {                                         //ja, dann
-        digitalWrite(REL, OFF);                 //Relais aus
-        TimeDelay=ONTIME;                       //Verzögerung unterbinden, sofort aus
+        pump_Set(OFF, PUMP_BUTTON);             //Relais aus
+        timer_Cancel(&RunOn);                   //Nachlauf unterbinden, sofort aus
       }
 
-    if (!digitalRead(ONSWITCH) && !digitalRead(OFFSWITCH))
+    if ((Inputs & (IN_ON|IN_OFF)) == (IN_ON|IN_OFF))
                                                 //beide Schalter gleichzeitig gedrückt?
       {                                         //ja, dann erst mal
-        digitalWrite(REL, OFF);                 //Relais aus
-        lcd.setCursor(0, 1);                    //und Curser für Tastenmenü positionieren
-      
-        if(Season==SOMMER)                      //ist aktuell SOMMER eingestellt?
-          {                                     //ja, dann
-            Season=WINTER;                      //auf WINTER schalten,
-            lcd.print("On <-- W --> Off");      //Tastermenü aktualisieren
-            OnLevel=LV2;                        //und oberen Level für diese Betriebsart festlegen
-          }
-        else                                    //nein, aktuell ist WINTER eingestellt
-          {                                     //deshalb
-            Season=SOMMER;                      //auf SOMMER schalten
-            lcd.print("On <-- S --> Off");      //und Tastermenü aktualisieren
-            OnLevel=LV4;                        //oberen Level für diese Betriebsart festlegen
-          }
-        _delay_ms(700);                         //zusätzliche Verzögerung, um Umspringen
-      }                                         //bei längerem Drücken zu vermeiden
-
-    if(digitalRead (OnLevel) || digitalRead (SKIM))
+        pump_Set(OFF, PUMP_BUTTON);             //Relais aus
+      }
+    if ((Inputs & (IN_ON|IN_OFF)) == (IN_ON|IN_OFF) && !timer_Armed(&SeasonLock))
+      {                                         //und wenn nicht gerade erst umgeschaltet
+        set_Season(Season==SOMMER ? WINTER : SOMMER); //Jahreszeit wechseln
+        timer_Arm(&SeasonLock, SEASONLOCK);     //Sperrzeit, um Umspringen bei längerem
+      }                                         //Drücken zu vermeiden
+    PROF_END(PROF_BUTTONS);
+
+    if(Inputs & (OnLevel|IN_SKIM))
                                                 //Abpumplevel erreicht oder Schwimmerschalter an?
-      {                                         //ja, dann Abpump-ISR starten
-        TimeDelay=0;                            //Verzögerungszzähler reseten
-        TCCR1B|=(1<<CS12);                      //Prescaler = 256; Timer1 startet
-        TIMSK1|=(1<<TOIE1);                     //ermöglicht Timer1 Overflow Interrupt, ISR aktiv
+      {                                         //ja, dann
+        pump_Set(ON, PUMP_LEVEL);               //Relais an und
+        start_RunOn();                          //Nachlaufzeit neu starten
       }
-      
-    if(!digitalRead(LV1) && digitalRead(REL))   //ist Level1 unterschritten und Pumpe an (Abpumpen von Hand)?
-      {                                         //ja, dann Abpump-ISR starten
-        TCCR1B|=(1<<CS12);                      //Prescaler = 256; Timer1 startet
-        TIMSK1|=(1<<TOIE1);                     //ermöglicht Timer1 Overflow Interrupt, ISR aktiv
+
+    if(inflow_Alarm() && !hal_RelayState())     //läuft die Zisterne bei diesem Zulauf bald über?
+      {                                         //ja, dann schon jetzt abpumpen, wie von
+        pump_Set(ON, PUMP_PREDICT);             //Hand bis unter OFFLevel und Nachlauf
+      }
+
+    if(!(Inputs & OFFLevel) && hal_RelayState()) //ist Level1 unterschritten und Pumpe an (Abpumpen von Hand)?
+      {                                         //ja, dann Nachlaufzeit starten,
+        if(!timer_Armed(&RunOn))                //eine laufende aber nicht verlängern
+          start_RunOn();
       }
 
-    if(digitalRead(REL))                        //ist Relais an?
-          {                                     //ja, dann 
-            move_Wheel(ON);                     //Symbol animieren
-          }
-          else                                  //nein, ist aus
-          {                                     //dann
-            move_Wheel(OFF);                    //statisch "|"anzeigen
-          }
- }
+  }
 else                                            //Frost wurde erkannt,
   {                                             //alle Funktionen aus
-    digitalWrite(REL, OFF);                     //Relais aus und
+    pump_Set(OFF, PUMP_FROST);                  //Relais aus,
+    timer_Cancel(&RunOn);                       //kein Nachlauf und
   }                                             //warten auf besseres Wetter
 }
 
-//------------------------------------- Functions -------------------------------------
-void get_Temp (void)                        //Temperatur auslesen, darstellen und Frost-Flag managen
+//-------------------------------------------------------------------------------------------
+void task_Display(void)                         //Pegelanzeige aktualisieren (100ms)
 {
-  sensors.requestTemperatures();            //globale Temperaturanforderungen an alle Geräte auf dem Bus
-  int Temp = sensors.getTempCByIndex(0);    //Temperatur vom ersten Sensor als Ganzzahl holen
+  if(timer_Armed(&IntroTimer))                  //Startbildschirm steht noch?
+    return;                                     //ja, Bildspeicher nicht ausgeben
+  if(timer_Flag(TF_INTRO) || screen.lost())     //gerade abgelaufen oder Daten verworfen?
+    GlyphsLoaded=0;                             //ja, dann zuerst die Sonderzeichen laden
+  if(GlyphsLoaded<GLYPHS)                       //je Aufruf so viele, wie in den Ringpuffer
+  {                                             //passen (7 von 8), nie darauf warten
+    while(GlyphsLoaded<GLYPHS && hal_LcdChar(GlyphsLoaded, Glyphs[GlyphsLoaded]))
+      GlyphsLoaded++;
+    if(GlyphsLoaded<GLYPHS)                     //Rest beim nächsten Aufruf
+      return;
+    show_Main();                                //alle da: Hauptbildschirm aufbauen
+  }
+  PROF_BEGIN(PROF_LEVEL);
+  show_Level();
+  PROF_END(PROF_LEVEL);
+  screen.flush();                               //nur geänderte Zeichen zum Display senden
+  BENCH_MARK(MARK_FRAME);
+}
 
-  if (Temp != DEVICE_DISCONNECTED_C)        //erfolgreiche Datenerfassung?
-  {                                         //ja, dann
-    lcd.setCursor(11, 0);                   //Curser positionieren
-    lcd.print(Temp);                        //Wert ausgeben
-    lcd.printByte(223);                     //Maßeinheit
-    lcd.print("C  ");                       //anhängen
-  }                                         
-  else                                      //nein, Sensor ab oder defekt
+//-------------------------------------------------------------------------------------------
+void task_Wheel(void)                           //Pumpenanimation weiterschalten (250ms)
+{
+  if(Frost==false)                              //bei Frost steht dort die Frostwarnung
   {
-    lcd.setCursor(11, 0);                   //Curser positionieren
-    lcd.print("---   ");
-    while(1)                                //keine weitere Funktion, bis Sensor wieder da ist
-    {
-      sensors.requestTemperatures();        //globale Temperaturanforderungen an alle Geräte auf dem Bus
-      Temp = sensors.getTempCByIndex(0);    //Temperatur vom ersten Sensor als Ganzzahl holen
-      if (Temp != DEVICE_DISCONNECTED_C)    //Sensor wieder da?
-        break;                              //ja, dann Schleife verlassen
-      _delay_ms(1000);                      //nein, dann 1s warten und nochmal versuchen
-    } 
+    PROF_BEGIN(PROF_WHEEL);
+    if(hal_RelayState())                        //ist Relais an?
+      {                                         //ja, dann
+        move_Wheel(ON);                         //Symbol animieren
+      }
+      else                                      //nein, ist aus
+      {                                         //dann
+        move_Wheel(OFF);                        //statisch "|"anzeigen
+      }
+    PROF_END(PROF_WHEEL);
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+#ifdef TELEMETRY
+void task_Telemetry(void)                       //Zustand als Rahmen senden (TELE_PERIOD)
+{
+  static uint8_t lcdErrors=0;                   //Stand beim vorigen Rahmen
+  TeleFrame f;
+  f.time=hal_Millis();
+  f.inputs=Inputs;
+  f.tempRaw=TempRaw;
+  f.state=(hal_RelayState() ? TS_RELAY : 0)
+         |(Season==SOMMER ? TS_SOMMER : 0)
+         |(Frost ? TS_FROST : 0);
+  f.runOn=0;
+  if(timer_Armed(&RunOn))                       //restliche Nachlaufzeit in 1/10 s
+  {
+    f.state|=TS_RUNON;
+    int32_t left=(int32_t)(RunOnEnd-f.time);
+    f.runOn=left>0 ? (left+99)/100 : 0;
+  }
+  f.loopMax=SchedLoopMax;                       //längster Durchlauf seit dem letzten Rahmen
+  SchedLoopMax=0;
+  f.overruns=0;
+  for(uint8_t i=0; i<sizeof(Tasks)/sizeof(Tasks[0]); i++)
+    f.overruns+=Tasks[i].overruns;
+  f.faults=(SensorFault ? TF_SENSOR : 0)
+          |(hal_LcdErrors()!=lcdErrors ? TF_LCD : 0)
+          |(LogLost ? TF_LOG : 0);
+  lcdErrors=hal_LcdErrors();
+  f.reset=LastReset.cause;
+  tele_Send(&f);
+}
+#endif
+
+//-------------------------------------------------------------------------------------------
+#ifdef MODBUS
+static uint16_t log_Reg(uint16_t reg)           //Register im Protokollfenster, liest je
+{                                               //Aufruf einen Eintrag (4 Byte) aus dem EEPROM
+  LogRecord rec;
+  uint8_t i=(reg-MB_IR_LOG)>>1;
+  if(!log_Read(LogAge+i, &rec))                 //leer oder älter als der Ring
+    return 0;
+  if((reg-MB_IR_LOG) & 1)
+    return rec.delta;
+  return (uint16_t)rec.code<<8 | rec.data;
+}
+
+//-------------------------------------------------------------------------------------------
+bool mb_Input(uint16_t reg, uint16_t *value)    //Input Register, siehe modbus.h
+{
+  uint32_t now=hal_Millis();
+  PumpStats stats;
+  pump_Stats(&stats);                           //nicht mitten in pump_Set() lesen
+  switch(reg)
+  {
+    case MB_IR_INPUTS: *value=Inputs; break;
+    case MB_IR_LEVEL:                           //LV0..LV4 von unten gezählt
+      *value=0;
+      while(*value<5 && (Inputs & (IN_LV0<<*value)))
+        (*value)++;
+      break;
+    case MB_IR_TEMP:
+      *value=TempRaw==TEMP_NONE ? MB_NONE : (uint16_t)(int16_t)((TempRaw*10L)/TEMP_RAW_PER_C);
+      break;
+    case MB_IR_TEMPRAW: *value=(uint16_t)TempRaw; break;
+    case MB_IR_RELAY: *value=hal_RelayState(); break;
+    case MB_IR_RUNON:
+      *value=0;
+      if(timer_Armed(&RunOn) && (int32_t)(RunOnEnd-now)>0)
+        *value=(RunOnEnd-now+99)/100;
+      break;
+    case MB_IR_FROST: *value=Frost; break;
+    case MB_IR_FAULTS:
+      *value=(SensorFault ? 0x01 : 0)|(LogLost ? 0x04 : 0);
+      break;
+    case MB_IR_STARTS: *value=stats.starts>0xFFFF ? 0xFFFF : stats.starts; break;
+    case MB_IR_RUNTIME: *value=pump_Runtime()/3600; break;
+    case MB_IR_LONGEST: *value=stats.longest>0xFFFF ? 0xFFFF : stats.longest; break;
+    case MB_IR_DUTYHOUR: *value=Pump.dutyHour; break;
+    case MB_IR_DUTYDAY: *value=Pump.dutyDay; break;
+    case MB_IR_DUTYMAX: *value=stats.dutyMax; break;
+    case MB_IR_INFLOW: *value=inflow_Liters(); break;
+    case MB_IR_RESET: *value=LastReset.cause; break;
+    case MB_IR_WATCHDOGS: *value=LastReset.watchdogs; break;
+    case MB_IR_CRCERRORS: *value=MbCrcErrors; break;
+    default:
+      if(reg<MB_IR_LOG || reg>=MB_IR_COUNT)
+        return false;
+      *value=log_Reg(reg);
+      break;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+static uint16_t level_Num(uint8_t bit)          //IN_LVx als Registerwert 1..5
+{
+  uint16_t n=1;
+  while(bit>IN_LV0)
+  {
+    bit>>=1;
+    n++;
+  }
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------
+bool mb_Holding(uint16_t reg, uint16_t *value)  //Holding Register, siehe modbus.h
+{
+  switch(reg)
+  {
+    case MB_HR_SEASON: *value=Season; break;
+    case MB_HR_ONTIME: *value=Cfg.onTime; break;
+    case MB_HR_FROST: *value=(uint16_t)(int16_t)Cfg.frostTemp; break;
+    case MB_HR_ONSUMMER: *value=level_Num(Cfg.onSummer); break;
+    case MB_HR_ONWINTER: *value=level_Num(Cfg.onWinter); break;
+    case MB_HR_PUMP: *value=hal_RelayState(); break;
+    case MB_HR_LOGAGE: *value=LogAge; break;
+    default: return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t mb_Write(uint16_t reg, uint16_t value)  //Holding Register schreiben, 0 oder MB_EX_xxx
+{
+  Config c=Cfg;
+  int16_t v=(int16_t)value;
+  switch(reg)
+  {
+    case MB_HR_SEASON:
+      if(value>SOMMER)
+        return MB_EX_VALUE;
+      if(value!=Season)                         //voller EEPROM-Puffer: Speichern wird
+        set_Season(value);                      //nachgeholt, nicht den Master wiederholen
+      return 0;                                 //lassen (er fände die Jahreszeit schon gesetzt)
+    case MB_HR_ONTIME:
+      if(value<1 || value>255)
+        return MB_EX_VALUE;
+      c.onTime=value;
+      break;
+    case MB_HR_FROST:
+      if(v<-20 || v>20)
+        return MB_EX_VALUE;
+      c.frostTemp=v;
+      break;
+    case MB_HR_ONSUMMER:
+    case MB_HR_ONWINTER:
+      if(value<3 || value>5)                    //oberhalb des Abschaltlevels LV1
+        return MB_EX_VALUE;
+      if(reg==MB_HR_ONSUMMER)
+        c.onSummer=IN_LV0<<(value-1);
+      else
+        c.onWinter=IN_LV0<<(value-1);
+      break;
+    case MB_HR_PUMP:                            //wie die Taster
+      if(value>1)
+        return MB_EX_VALUE;
+      if(value)
+      {
+        if(Frost || SensorFault)                //wie Taster EIN gesperrt
+          return MB_EX_FAIL;
+        pump_Set(ON, PUMP_MODBUS);
+        if(timer_Armed(&RunOn))
+          start_RunOn();
+      }
+      else
+      {
+        pump_Set(OFF, PUMP_MODBUS);
+        timer_Cancel(&RunOn);
+      }
+      return 0;
+    case MB_HR_LOGAGE:                          //nur das Lesefenster, kein EEPROM
+      if(value>=LOG_SLOTS)
+        return MB_EX_VALUE;
+      LogAge=value;
+      return 0;
+    default:
+      return MB_EX_ADDRESS;
+  }
+  cfg_Save(&c);                                 //bei voller Warteschlange vorgemerkt,
+  Cfg=c;                                        //cfg_Flush holt das Schreiben nach
+  OnLevel=Season==SOMMER ? Cfg.onSummer : Cfg.onWinter;
+  return 0;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------
+void task_Temp(void)                            //Temperaturmessung (1s)
+{
+  PROF_BEGIN(PROF_TEMP);
+  get_Temp();
+  PROF_END(PROF_TEMP);
+}
+
+//-------------------------------------------------------------------------------------------
+void get_Temp (void)                        //Temperatur auslesen, darstellen und Frost-Flag managen
+{                                           //Task (1s), kehrt immer sofort zurück
+  if(timer_Armed(&TempTimer))               //Wandlung oder Messpause läuft noch?
+  {
+    return;                                 //ja, beim nächsten Aufruf wieder nachsehen
+  }
+  if(TempState!=TEMP_WAIT)                  //keine Wandlung offen?
+  {                                         //dann
+    if(TempState==TEMP_INIT)                //beim ersten Aufruf
+      hal_TempInit();                       //Bus starten, Sensor suchen
+    hal_TempStart();                        //Wandlung auf allen Geräten am Bus anstoßen,
+    timer_Arm(&TempTimer, hal_TempConvTime()); //sie läuft bis zum nächsten Aufruf
+    TempState=TEMP_WAIT;
+    return;
+  }
+  TempState=TEMP_REQUEST;                   //Ergebnis abholen, nächste Wandlung erst nach
+  timer_Arm(&TempTimer, TEMPPAUSE);         //der Messpause, solange ruhen Sensor und Bus
+
+  int16_t raw = hal_TempRead();             //Rohwert in 1/128°C, sucht bei Fehler neu
+  TempRaw = raw;
+  int Temp = raw/TEMP_RAW_PER_C;            //ganze Grad genügen für Anzeige und Frost
+
+  if (raw == TEMP_NONE)                     //Sensor ab oder defekt? Dann Notbetrieb:
+  {                                         //Temperatur unbekannt, Überlaufschutz bleibt aktiv,
+    if(!SensorFault)                        //nur den Ausfall protokollieren, nicht jeden
+      log_Event(LOG_SENSOR_LOST, 0);        //vergeblichen Versuch
+    SensorFault=true;                       //manuelles Einschalten ist gesperrt. Der Bus wird
+    Frost=false;                            //im nächsten Messzyklus erneut abgefragt
+    show_Temp();                            //"?" und "---" ausgeben
     return;                                 //und ohne Temperaturänderung zurück
   }
 
-  if(Temp<FROSTTEMP)                        //Frostgefahr?
+  if(SensorFault)                           //Sensor war ausgefallen
+    log_Event(LOG_SENSOR_OK, (uint8_t)Temp);
+  if(Temp<Cfg.frostTemp)                   //Frostgefahr?
   {
+    if(!Frost)
+      log_Event(LOG_FROST_ON, (uint8_t)Temp);
     Frost=true;                             //ja, dann Frost-Flag setzen
-    lcd.setCursor(8, 0);                    //Curser setzen,
-    lcd.print("!!");                        //Frostwarnung ausgeben
-    digitalWrite(REL, OFF);                 //und Relais ausschalten
-
+    pump_Set(OFF, PUMP_FROST);              //und Relais ausschalten
   }
-  else if (Temp>FROSTTEMP)                  //nein, kein Frost
+  else if (Temp>Cfg.frostTemp || SensorFault) //nein, kein Frost (oder Sensor gerade wieder da)
   {                                         //dann
+    if(Frost)
+      log_Event(LOG_FROST_OFF, (uint8_t)Temp);
     Frost=false;                            //Frost-Flag löschen
-    lcd.setCursor(9, 0);                    //"*" = Sonne für "OK"
-    lcd.print("*");                         //ausgeben
   }
+  SensorFault=false;                        //Sensor liefert (wieder) Werte
+  show_Temp();                              //Wert und Frostzustand ausgeben
   return;                                   //und zurück
 }                                          
+
+//-------------------------------------------------------------------------------------------
+void show_Temp (void)                       //Temperaturfeld aus TempRaw, Frost und SensorFault
+{                                           //zeichnen, auch nach screen.clear() in show_Main
+  if(SensorFault)                           //Sensor ausgefallen?
+  {
+    screen.setCursor(9, 0);                 //Curser positionieren
+    screen.print("?");                      //Frostzustand unbekannt
+    screen.setCursor(11, 0);
+    screen.print("---   ");                 //Temperatur unbekannt
+    return;
+  }
+  if(TempRaw==TEMP_NONE)                    //noch keine Messung, Feld bleibt leer
+    return;
+  screen.setCursor(11, 0);                  //Curser positionieren
+  screen.print(TempRaw/TEMP_RAW_PER_C);     //Wert ausgeben
+  screen.printByte(223);                    //Maßeinheit
+  screen.print("C  ");                      //anhängen
+  if(Frost)
+  {
+    screen.setCursor(8, 0);                 //Curser setzen,
+    screen.print("!!");                     //Frostwarnung ausgeben
+  }
+  else
+  {
+    screen.setCursor(9, 0);                 //"*" = Sonne für "OK"
+    screen.print("*");                      //ausgeben
+  }
+}
  
 //-------------------------------------------------------------------------------------------
 void show_Intro (void)                      //Intro-Bildschirm anzeigen
 {
-  lcd.clear();                              //Bildschirm putzen
-  lcd.print(" ZISTERNE  V1.1");             //Text erste Zeile ausgeben
-  lcd.setCursor(0, 1);                      //Text zweite Zeile ausgeben
-  lcd.print("c2025 by P.Lampe ");
-  _delay_ms(3000);                          //Anzeigezeit abwarten
-  lcd.clear();                              //und dann Bildschirm wieder putzen
+  screen.clear();                           //Bildschirm putzen
+  screen.print(" ZISTERNE  V1.1");          //Text erste Zeile ausgeben
+  screen.setCursor(0, 1);                   //Text zweite Zeile ausgeben
+  if(LastReset.cause==RESET_WATCHDOG)       //nach einem Hänger stattdessen die Diagnose:
+  {                                         //Watchdog und Index des hängenden Tasks
+    screen.print("Watchdog Task ");
+    screen.print(LastReset.task);
+  }
+  else
+    screen.print("c2025 by P.Lampe ");
+  screen.flush();                           //hinter der Initialisierung einreihen
+  timer_Arm(&IntroTimer, INTROTIME);        //Anzeigezeit läuft im Zeitrad ab
   return;
 }
 
+//-------------------------------------------------------------------------------------------
+void show_Main (void)                       //statischen Teil des Hauptbildschirms zeichnen,
+{                                           //die Sonderzeichen hat task_Display geladen
+  screen.clear();                           //Startbildschirm putzen
+  screen.printByte(5);                      //"Brunnenboden" statisch anzeigen
+  screen.setCursor(0, 1);                   //Tastenmenü positionieren
+  if(Season==SOMMER)                        //und passend zur Jahreszeit anzeigen
+    screen.print("On <-- S --> Off");
+  else
+    screen.print("On <-- W --> Off");
+  show_Temp();                              //Temperaturfeld nicht bis zur nächsten Messung leer lassen
+  return;
+}
+
+//-------------------------------------------------------------------------------------------
+bool set_Season(bool season)                //Jahreszeit umschalten (Tasten oder Modbus),
+{                                           //false = EEPROM-Puffer voll, wird nachgeholt
+  Season=season;
+  screen.setCursor(0, 1);                   //Curser für Tastenmenü positionieren
+  if(Season==SOMMER)                        //ist jetzt SOMMER eingestellt?
+    {                                       //ja, dann
+      screen.print("On <-- S --> Off");     //Tastermenü aktualisieren
+      OnLevel=Cfg.onSummer;                 //oberen Level für diese Betriebsart festlegen
+    }
+  else                                      //nein, WINTER
+    {                                       //deshalb
+      screen.print("On <-- W --> Off");     //Tastermenü aktualisieren
+      OnLevel=Cfg.onWinter;                 //und oberen Level für diese Betriebsart festlegen
+    }
+  log_Event(LOG_SEASON, Season);
+  Cfg.season=Season;                        //Jahreszeit übersteht den nächsten Stromausfall,
+  return cfg_Save(&Cfg);                    //geschrieben wird im Hintergrund, bei
+                                            //voller Warteschlange über cfg_Flush
+}
+
+//-------------------------------------------------------------------------------------------
+void start_RunOn(void)                      //Nachlaufzeit (neu) starten, Ablauf für die
+{                                           //Telemetrie merken
+  timer_Arm(&RunOn, RUNON_MS);
+  RunOnEnd=hal_Millis()+RUNON_MS;
+}
+
+//-------------------------------------------------------------------------------------------
+static void end_RunOn(void)                 //Nachlaufzeit abgelaufen, läuft im Interrupt
+{                                           //des Zeitrads, daher nur Relais aus
+  pump_Set(OFF, PUMP_RUNON);
+}
+
 //-------------------------------------------------------------------------------------------
 void show_Level (void)                      //Anzeige der Pegelstände im Display
 {
-  Level[0]=digitalRead(LV0);                //aktuelle Sonden-Level in Array einlesen
-  Level[1]=digitalRead(LV1);
-  Level[2]=digitalRead(LV2);
-  Level[3]=digitalRead(LV3);
-  Level[4]=digitalRead(LV4);
-  
-  for (int i=0; i<5; i++)                   //Darstellung des Status im Display
+  for (int i=0; i<5; i++)                   //Sondenstatus aus dem Eingangsabbild darstellen
   {
-    lcd.setCursor(i+1, 0);                  //Curser an entsprechende Stelle platzieren
-    if(Level[i])                            //Level erreicht?
+    screen.setCursor(i+1, 0);               //Curser an entsprechende Stelle platzieren
+    if(Inputs & (IN_LV0<<i))                //Level erreicht?
     {                                       //ja, dann
-      lcd.printByte(4);                     //Segment "voll" anzeigen
+      screen.printByte(4);                  //Segment "voll" anzeigen
     }
     else                                    //nein,
     {                                       //dann
-      lcd.printByte(6);                     //Segment "leer" anzeigen
+      screen.printByte(6);                  //Segment "leer" anzeigen
     }
 
   }
-  lcd.setCursor(6, 0);                      //Curser an letzte Position
-  lcd.printByte(7);                         //"Brunnenrand" anzeigen
+  screen.setCursor(6, 0);                   //Curser an letzte Position
+  screen.printByte(7);                      //"Brunnenrand" anzeigen
   return;
 }
 
@@ -283,32 +693,16 @@ void move_Wheel(bool action)                //zeigt Aktivitätssymbole für Pump
     {
       counter=0;              
     }
-    lcd.setCursor(8, 0);                    //Curser platzieren
-    lcd.printByte(0+counter);               //Animationsframe anzeigen
+    screen.setCursor(8, 0);                 //Curser platzieren
+    screen.printByte(0+counter);            //Animationsframe anzeigen
     counter++;                              //für nächsten Aufruf inkrementiern
   }
   else
   {
-    lcd.setCursor(8, 0);                    //Curser platzieren
-    lcd.printByte(0);                       //starres Symbol "|" anzeigen
+    screen.setCursor(8, 0);                 //Curser platzieren
+    screen.printByte(0);                    //starres Symbol "|" anzeigen
   }
   return;                                   //Rücksprung
 }
 //-------------------------------------------------------------------------------------------
-ISR(TIMER1_OVF_vect)
-{
-  TimeDelay++;                              //Verzögerungszeit hochzählen  
-  if (TimeDelay<=ONTIME)                    //Innerhalb der Verzögerungszeit?
-  {                                         //ja, dann
-     digitalWrite(REL,ON);                  //Relais an
-  }
-  else                                      //nein, Zeit abgelaufen
-  {                                         //dann
-    digitalWrite(REL, OFF);                 //Relais aus
-    TCCR1B=0;                               //Timer anhalten und
-    TIMSK1&=~(1<<TOIE1);                    //Interruptaufruf stoppen
-  }
-  TCNT1 = 0xBDC;                            //aber erneutes Timer-Preloading für 1s 
-}
-//-------------------------------------------------------------------------------------------
 // Ende der Datei main.cpp
\ No newline at end of file
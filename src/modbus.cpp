@@ -0,0 +1,138 @@
+/*
+Titel     : Modbus-RTU-Slave für die Hausautomation
+--------------------------------------------------------------------------------------
+Funktion  : Siehe modbus.h. Register und Zähler stehen im Rahmen High-Byte zuerst,
+            die CRC Low-Byte zuerst. Rahmen mit falscher CRC oder fremder Adresse
+            bleiben nach der Spezifikation unbeantwortet.
+--------------------------------------------------------------------------------------
+*/
+#ifdef MODBUS
+#include "hal.h"
+#include "crc.h"
+#include "modbus.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define MB_FC_HOLDING 3                                 //Holding Register lesen
+#define MB_FC_INPUT 4                                   //Input Register lesen
+#define MB_FC_WRITE 6                                   //ein Register schreiben
+#define MB_FC_WRITE_MULTI 16                            //mehrere Register schreiben
+#define MB_TX (3+2*MB_REGS_MAX+2)                       //längste Antwort
+
+//------------------------------------- Variablen -------------------------------------
+uint16_t MbCrcErrors=0;
+
+static uint8_t Tx[MB_TX];                               //Antwort
+
+//------------------------------------- Functions -------------------------------------
+static uint16_t get16(const uint8_t *p)                 //High-Byte zuerst
+{
+  return (uint16_t)p[0]<<8 | p[1];
+}
+
+//-------------------------------------------------------------------------------------------
+static uint8_t read_Regs(const uint8_t *rx, uint8_t len, uint8_t *n)
+{                                                       //03/04: Antwort ab Tx[2] aufbauen,
+                                                        //len ohne CRC
+  if(len!=6)
+    return MB_EX_VALUE;
+  uint16_t reg=get16(rx+2);
+  uint16_t count=get16(rx+4);
+  if(count==0 || count>MB_REGS_MAX)
+    return MB_EX_VALUE;
+  Tx[2]=count*2;
+  for(uint8_t i=0; i<count; i++)
+  {
+    uint16_t value;
+    bool ok=rx[1]==MB_FC_INPUT ? mb_Input(reg+i, &value) : mb_Holding(reg+i, &value);
+    if(!ok)
+      return MB_EX_ADDRESS;
+    Tx[3+2*i]=value>>8;
+    Tx[4+2*i]=(uint8_t)value;
+  }
+  *n=3+count*2;
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+static uint8_t write_Regs(const uint8_t *rx, uint8_t len, uint8_t *n)
+{                                                       //06/16: Antwort wiederholt den Kopf
+  uint16_t reg=get16(rx+2);
+  if(rx[1]==MB_FC_WRITE)
+  {
+    if(len!=6)
+      return MB_EX_VALUE;
+    uint8_t ex=mb_Write(reg, get16(rx+4));
+    if(ex)
+      return ex;
+    *n=6;
+    return 0;
+  }
+  uint16_t count=get16(rx+4);
+  if(len<7 || count==0 || count>MB_REGS_MAX || rx[6]!=count*2 || len!=7+count*2)
+    return MB_EX_VALUE;
+  for(uint8_t i=0; i<count; i++)                        //der Reihe nach, beim ersten Fehler
+  {                                                     //Schluss, die davor bleiben geschrieben
+    uint8_t ex=mb_Write(reg+i, get16(rx+7+2*i));
+    if(ex)
+      return ex;
+  }
+  *n=6;
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+void mb_Init(void)
+{
+  MbCrcErrors=0;
+  hal_UartInit(MB_BAUD, true);
+}
+
+//-------------------------------------------------------------------------------------------
+void mb_Task(void)                                      //Task (MB_PERIOD): höchstens einen Rahmen
+{                                                       //je Aufruf, dauert Bruchteile einer ms
+  const uint8_t *rx;
+  uint8_t len=hal_UartFrame(&rx);
+  if(len==0)
+    return;
+  if(len<4 || crc16(rx, len-2)!=(rx[len-2] | (uint16_t)rx[len-1]<<8))
+  {
+    if(MbCrcErrors!=0xFFFF)
+      MbCrcErrors++;
+    hal_UartNext();
+    return;
+  }
+  len-=2;
+  uint8_t addr=rx[0];
+  uint8_t fn=rx[1];
+  if(addr!=MB_ADDR && addr!=0)                          //nicht für uns
+  {
+    hal_UartNext();
+    return;
+  }
+  uint8_t n=0;
+  uint8_t ex;
+  for(uint8_t i=0; i<6 && i<len; i++)                   //Kopf für die Antwort auf 06/16
+    Tx[i]=rx[i];
+  if(fn==MB_FC_HOLDING || fn==MB_FC_INPUT)
+    ex=addr ? read_Regs(rx, len, &n) : MB_EX_FUNCTION;  //Lesen per Broadcast gibt es nicht
+  else if(fn==MB_FC_WRITE || fn==MB_FC_WRITE_MULTI)
+    ex=len>=6 ? write_Regs(rx, len, &n) : MB_EX_VALUE;
+  else
+    ex=MB_EX_FUNCTION;
+  hal_UartNext();                                       //Puffer frei für die nächste Anfrage
+  if(addr==0)                                           //Broadcast: keine Antwort
+    return;
+  Tx[0]=MB_ADDR;
+  Tx[1]=fn;
+  if(ex)                                                //Ausnahme: Funktion mit Bit 7
+  {
+    Tx[1]=fn|0x80;
+    Tx[2]=ex;
+    n=3;
+  }
+  uint16_t crc=crc16(Tx, n);
+  Tx[n++]=(uint8_t)crc;
+  Tx[n++]=crc>>8;
+  hal_UartSend(Tx, n);                                  //64 Byte Puffer, die längste Antwort
+}                                                       //hat 37; der Master wartet sie ab
+#endif
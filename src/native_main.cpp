@@ -0,0 +1,190 @@
+/*
+Titel     : Hauptprogramm für den Host (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Startet die Steuerung mit setup() und lässt sie im Zisternensimulator
+            (sim.cpp) laufen. Am Ende stehen Display, Bilanz der Wassermengen und
+            der Zeitraffer gegenüber Echtzeit.
+            Aufruf: pio run -e native && .pio/build/native/program [Optionen]
+              -d Tage        Simulationsdauer (Vorgabe 1)
+              -s Tag         Starttag im Jahr, 0 = 1. Januar (Vorgabe 120)
+              -l mm          Anfangspegel (Vorgabe 300)
+              -r Datei       Regenprofil, je Zeile mm/h einer Stunde
+              -x Startwert   Startwert für das synthetische Regenprofil
+              -a m²          Dachfläche (Vorgabe 20)
+              -p l/h         Förderleistung der Pumpe (Vorgabe 3000)
+              -t Datei       Verlauf je Minute als CSV (Zeit;Pegel;Temperatur;Pumpe)
+              -w Sekunde     ab dann hängt der nächste Sensorzugriff (Watchdog-Test)
+              -e Anzahl      die jüngsten Einträge des Ereignisprotokolls ausgeben
+              -u Datei       Telemetrierahmen binär schreiben (nur mit -DTELEMETRY)
+              -m Datei       Modbus-Anfragen je Zeile "Sekunde Hexbytes", CRC wird
+                             angehängt, Antworten auf stdout (nur mit -DMODBUS)
+--------------------------------------------------------------------------------------
+*/
+#if !defined(ARDUINO) && !defined(PIO_UNIT_TESTING)      //pio test bringt sein eigenes main() mit
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "eeprom_map.h"
+#include "sim.h"
+#include "profile.h"
+#include "eventlog.h"
+#include "pump.h"
+
+//------------------------------------- Prototypes ------------------------------------
+void setup(void);                                       //aus main.cpp
+
+//-------------------------------------------------------------------------------------------
+static double wall_Time(void)                           //Echtzeit in s
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+//-------------------------------------------------------------------------------------------
+static void log_Print(int count)                        //Ereignisprotokoll lesbar ausgeben,
+{                                                       //ältester der gezeigten Einträge zuerst
+  static const char *const name[]=
+  {
+    "?", "Start", "Pumpe ein", "Pumpe aus", "Sonden", "Skimmer", "Frost",
+    "Frost vorbei", "Jahreszeit", "Sensor fehlt", "Sensor ok", "Watchdog"
+  };
+  LogRecord rec;
+  int n=0;
+  while(n<count && log_Read(n, &rec))
+    n++;
+  uint32_t t=0;                                         //Sekunden vor dem jüngsten Eintrag
+  for(int i=0; i<n-1; i++)
+  {
+    log_Read(i, &rec);
+    t+=rec.delta;
+  }
+  for(int i=n-1; i>=0; i--)
+  {
+    log_Read(i, &rec);
+    printf("Ereignis:     %8.2f h  %-13s %3u\n", -(t/3600.0),
+           rec.code<sizeof(name)/sizeof(name[0]) ? name[rec.code] : "?", (unsigned)rec.data);
+    if(i>0)
+    {
+      LogRecord next;
+      log_Read(i-1, &next);
+      t-=next.delta;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  SimConfig config={ 20, 3000, 300, 120, 1, NULL, NULL, 0, NULL };
+  double days=1;
+  int events=0;
+  int opt;
+  while((opt=getopt(argc, argv, "d:s:l:r:x:a:p:t:w:e:u:m:"))!=-1)
+  {
+    switch(opt)
+    {
+      case 'd': days=atof(optarg); break;
+      case 's': config.startDay=atoi(optarg); break;
+      case 'l': config.level=atof(optarg); break;
+      case 'r': config.rain=optarg; break;
+      case 'x': config.seed=strtoul(optarg, NULL, 0); break;
+      case 'a': config.roof=atof(optarg); break;
+      case 'p': config.pump=atof(optarg); break;
+      case 'w': config.hang=atof(optarg); break;
+      case 'e': events=atoi(optarg); break;
+      case 'u':
+        SimUart=fopen(optarg, "wb");
+        if(!SimUart)
+        {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      case 'm':
+        config.modbus=fopen(optarg, "r");
+        if(!config.modbus)
+        {
+          perror(optarg);
+          return 1;
+        }
+        SimUartHex=true;
+        break;
+      case 't':
+        config.trace=fopen(optarg, "w");
+        if(!config.trace)
+        {
+          perror(optarg);
+          return 1;
+        }
+        break;
+      default:
+        fprintf(stderr, "Aufruf: %s [-d Tage] [-s Tag] [-l mm] [-r Datei] [-x Startwert]"
+                        " [-a m2] [-p l/h] [-t Datei] [-w s] [-e n] [-u Datei] [-m Datei]\n", argv[0]);
+        return 1;
+    }
+  }
+  if(!sim_Init(&config))
+  {
+    fprintf(stderr, "Regenprofil %s nicht lesbar\n", config.rain);
+    return 1;
+  }
+
+  double start=wall_Time();
+  setup();
+  sim_Run((uint32_t)(days*86400));
+  double wall=wall_Time()-start;
+
+  const SimStats *r=&SimResult;
+  double simulated=sim_Time();                          //hal_Millis() liefe nach 49,7 Tagen über
+  printf("+----------------+\n");
+  printf("|%s|\n", sim_LcdLine(0));
+  printf("|%s|\n", sim_LcdLine(1));
+  printf("+----------------+\n");
+  printf("Pegel:        %.0f mm (min %.0f, max %.0f)\n", sim_Level(), r->levelMin, r->levelMax);
+  printf("Zulauf:       %.0f l\n", r->rain);
+  printf("Abgepumpt:    %.0f l, %u Starts, %.1f h Laufzeit\n",
+         r->pumped, (unsigned)r->pumpStarts, r->pumpTime/3600);
+  printf("Überlauf:     %.0f l, %u Ereignisse, %.0f s\n",
+         r->overflow, (unsigned)r->overflows, r->overflowTime);
+  printf("Statistik:    %u Starts, %.1f h Laufzeit, längster Lauf %u s (Steuerung)\n",
+         (unsigned)Stats.starts, pump_Runtime()/3600.0, (unsigned)Stats.longest);
+  printf("Tastgrad:     %.2f%% letzte Stunde, %.2f%% letzter Tag, %.2f%% höchster Tag\n",
+         Pump.dutyHour/100.0, Pump.dutyDay/100.0, Stats.dutyMax/100.0);
+  printf("Trockenlauf:  %.0f s\n", r->dryRun);
+  printf("Frost:        %.1f h\n", r->frostTime/3600);
+  printf("Durchläufe:   %llu\n", (unsigned long long)r->steps);
+  printf("Strom:        %.2f mA Mittel, CPU %.2f%% wach (Schätzung)\n",
+         r->current, simulated>0 ? r->awake*100/simulated : 0);
+  uint32_t eeMax=0;                                     //Verschleiß des EEPROM hochrechnen
+  for(uint16_t i=0; i<EE_SIZE; i++)
+  {
+    if(SimEeWrites[i]>eeMax)
+      eeMax=SimEeWrites[i];
+  }
+  if(eeMax)
+    printf("EEPROM:       max. %u Schreibzyklen je Byte, 100000 reichen %.0f Jahre\n",
+           (unsigned)eeMax, simulated/eeMax*100000/(365*86400.0));
+  if(r->hangs || r->watchdogs)
+    printf("Watchdog:     %u Hänger, %u Resets, Relais nach %.3f s aus, Neustart nach %.3f s\n",
+           (unsigned)r->hangs, (unsigned)r->watchdogs, r->safeTime, r->recoverTime);
+  log_Flush();                                          //noch Vorgemerktes einreihen
+  if(events)
+    log_Print(events);
+  printf("Zeitraffer:   %.0f s in %.2f s = %.0fx Echtzeit\n",
+         simulated, wall, wall>0 ? simulated/wall : 0);
+#ifdef PROFILE
+  prof_Dump();                                          //Laufzeiten in virtueller Zeit
+#endif
+  if(config.trace)
+    fclose(config.trace);
+  if(SimUart)
+    fclose(SimUart);
+  if(config.modbus)
+    fclose(config.modbus);
+  return 0;
+}
+#endif
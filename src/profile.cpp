@@ -0,0 +1,156 @@
+/*
+Titel     : Laufzeitprofil im Zielsystem
+--------------------------------------------------------------------------------------
+Funktion  : Siehe profile.h. Wird nur mit -DPROFILE übersetzt. Die Ausgabe kommt
+            ohne printf aus, damit das Profil selbst klein bleibt:
+              prof id     n    min   mean    max
+              prof 0     12   1824   1910   2264
+              loop 2^k  Anzahl
+            Mit 'l' folgt das Ereignisprotokoll, jüngster Eintrag zuerst:
+              log age code data  dt
+--------------------------------------------------------------------------------------
+*/
+#ifdef PROFILE
+#include "hal.h"
+#include "profile.h"
+#include "eventlog.h"
+
+//------------------------------------- Variablen -------------------------------------
+static ProfStat Stat[PROF_POINTS];                      //je Messpunkt 10 Byte
+static uint16_t Hist[PROF_BUCKETS];                     //Periode von loop(), log2-Fächer
+static uint32_t LoopLast;                               //Beginn des letzten loop()-Aufrufs
+static bool LoopSeen;
+
+//------------------------------------- Functions -------------------------------------
+static void prof_Reset(void)                            //alle Messwerte löschen
+{
+  for(uint8_t i=0; i<PROF_POINTS; i++)
+  {
+    Stat[i].count=0;
+    Stat[i].min=0xFFFF;
+    Stat[i].max=0;
+    Stat[i].sum=0;
+  }
+  for(uint8_t i=0; i<PROF_BUCKETS; i++)
+    Hist[i]=0;
+  LoopSeen=false;
+}
+
+//-------------------------------------------------------------------------------------------
+void prof_Init(void)
+{
+  prof_Reset();
+  hal_SerialInit();
+}
+
+//-------------------------------------------------------------------------------------------
+void prof_Add(uint8_t id, uint32_t us)                  //aus Hauptprogramm und ISR, je Messpunkt
+{                                                       //aber nur aus einem der beiden
+  ProfStat *s=&Stat[id];
+  uint16_t v=us>0xFFFF ? 0xFFFF : us;
+  if(s->count==0xFFFF)                                  //voll, Mittelwert bleibt gültig
+    return;
+  s->count++;
+  s->sum+=v;
+  if(v<s->min)
+    s->min=v;
+  if(v>s->max)
+    s->max=v;
+}
+
+//-------------------------------------------------------------------------------------------
+void prof_Loop(void)                                    //Abstand zum letzten Aufruf einordnen
+{
+  uint32_t now=hal_Micros();
+  if(LoopSeen)
+  {
+    uint32_t period=now-LoopLast;
+    uint8_t k=0;
+    while(k<PROF_BUCKETS-1 && period>=(1UL<<k))         //Fach k: 2^(k-1) <= Periode < 2^k
+      k++;
+    if(Hist[k]!=0xFFFF)
+      Hist[k]++;
+  }
+  LoopLast=now;
+  LoopSeen=true;
+}
+
+//-------------------------------------------------------------------------------------------
+static void put_Num(uint32_t value, uint8_t width)      //Zahl rechtsbündig ausgeben
+{
+  char buf[11];
+  uint8_t i=sizeof(buf)-1;
+  buf[i]=0;
+  do
+  {
+    buf[--i]='0'+value%10;
+    value/=10;
+  }
+  while(value && i);
+  while(i && sizeof(buf)-1-i<width)
+    buf[--i]=' ';
+  hal_SerialWrite(&buf[i]);
+}
+
+//-------------------------------------------------------------------------------------------
+void prof_Dump(void)
+{
+  hal_SerialWrite("prof id     n    min   mean    max\r\n");
+  for(uint8_t i=0; i<PROF_POINTS; i++)
+  {
+    uint8_t lock=hal_Lock();                            //Kopie unter Sperre: PROF_TICK zählt in
+    ProfStat s=Stat[i];                                 //der Timer-ISR, sonst passen count, sum
+    hal_Unlock(lock);                                   //und max nicht zusammen
+    hal_SerialWrite("prof");
+    put_Num(i, 3);
+    put_Num(s.count, 6);
+    put_Num(s.count ? s.min : 0, 7);
+    put_Num(s.count ? s.sum/s.count : 0, 7);
+    put_Num(s.max, 7);
+    hal_SerialWrite("\r\n");
+  }
+  for(uint8_t k=0; k<PROF_BUCKETS; k++)
+  {
+    if(Hist[k]==0)
+      continue;
+    hal_SerialWrite("loop 2^");
+    put_Num(k, 2);
+    put_Num(Hist[k], 6);
+    hal_SerialWrite("\r\n");
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void log_Dump(void)                              //Ereignisprotokoll ausgeben, die
+{                                                       //Steuerung läuft dabei weiter
+  LogRecord rec;
+  hal_SerialWrite("log age code data    dt\r\n");
+  for(uint8_t age=0; log_Read(age, &rec); age++)
+  {
+    hal_SerialWrite("log");
+    put_Num(age, 4);
+    put_Num(rec.code, 5);
+    put_Num(rec.data, 5);
+    put_Num(rec.delta, 6);
+    hal_SerialWrite("\r\n");
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void prof_Task(void)                                    //Task (100ms): Kommandos abfragen
+{
+  int16_t c=hal_SerialRead();
+  if(c=='p')
+  {
+    prof_Dump();
+  }
+  else if(c=='r')
+  {
+    prof_Reset();
+  }
+  else if(c=='l')
+  {
+    log_Dump();
+  }
+}
+#endif
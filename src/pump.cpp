@@ -0,0 +1,178 @@
+/*
+Titel     : Pumpenrelais und Betriebsstatistik
+--------------------------------------------------------------------------------------
+Funktion  : Siehe pump.h. Die Laufzeit wird bis Mark abgerechnet: bei jedem
+            Wechsel und in pump_Task() einmal je Sekunde. Ein Lauf über eine
+            Stundengrenze verteilt sich so auf beide Stunden. Die Millisekunden
+            laufen in OnMs auf und gehen in ganzen Sekunden in Stats.runtime.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "crc.h"
+#include "eeprom_map.h"
+#include "pump.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define HOUR_MS 3600000UL                               //eine Stunde in ms
+#define STATS_CRC_LEN (sizeof(PumpStats)-1)             //CRC über alles vor dem CRC-Byte
+
+//------------------------------------- Variablen -------------------------------------
+PumpStats Stats;
+volatile PumpState Pump;
+
+static uint32_t Mark;                                   //Laufzeit bis hierher abgerechnet (ms)
+static uint32_t OnAt;                                   //Beginn des laufenden Laufs
+static uint16_t OnMs;                                   //noch nicht in Stats.runtime (ms)
+static uint32_t HourMs;                                 //Laufzeit in der laufenden Stunde
+static uint32_t DayMs;                                  //Laufzeit am laufenden Tag
+static uint32_t HourStart;                              //Beginn der laufenden Stunde
+static uint8_t Hours;                                   //volle Stunden am laufenden Tag
+static uint8_t Slot;                                    //Platz des zuletzt geschriebenen Eintrags
+static uint32_t Saved;                                  //Stats.runtime beim letzten Schreiben
+static uint32_t SavedStarts;                            //Stats.starts beim letzten Schreiben
+static bool SavePending=false;                          //Warteschlange war voll, erneut versuchen
+
+//------------------------------------- Functions -------------------------------------
+static void account(uint32_t now)                       //Laufzeit bis now abrechnen,
+{                                                       //nur unter Sperre aufrufen
+  if(hal_RelayState())
+  {
+    uint32_t ms=now-Mark;
+    HourMs+=ms;
+    DayMs+=ms;
+    ms+=OnMs;
+    Stats.runtime+=ms/1000;
+    OnMs=ms%1000;
+  }
+  Mark=now;
+}
+
+//-------------------------------------------------------------------------------------------
+void pump_Init(void)                                    //einmal über den Ring, neuester gültiger
+{                                                       //Eintrag gilt (wie cfg_Load)
+  bool found=false;
+  for(uint8_t i=0; i<STATS_SLOTS; i++)
+  {
+    PumpStats s;
+    hal_EeRead(EE_STATS+i*sizeof(PumpStats), &s, sizeof(PumpStats));
+    if(crc8((const uint8_t *)&s, STATS_CRC_LEN)!=s.crc || s.seq==0xFF)
+      continue;                                         //leer (0xFF) oder angefangen
+    if(!found || (int8_t)(s.seq-Stats.seq)>0)
+    {
+      Stats=s;
+      Slot=i;
+      found=true;
+    }
+  }
+  if(!found)                                            //neu: bei null beginnen, der erste
+  {                                                     //Eintrag landet auf Platz 0
+    Stats.starts=Stats.runtime=Stats.longest=0;
+    Stats.dutyMax=0;
+    Stats.seq=0;
+    Slot=STATS_SLOTS-1;
+  }
+  Saved=Stats.runtime;
+  SavedStarts=Stats.starts;
+  SavePending=false;
+  Mark=HourStart=hal_Millis();
+  OnMs=0;
+  HourMs=DayMs=0;
+  Hours=0;
+  Pump.at=Mark;
+  Pump.source=0;
+  Pump.dutyHour=Pump.dutyDay=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void pump_Set(bool on, uint8_t source)                  //eval_Control ruft alle 10ms, ohne
+{                                                       //Wechsel kostet das nur einen Vergleich
+  if(on==hal_RelayState())
+    return;
+  uint8_t lock=hal_Lock();
+  uint32_t now=hal_Millis();
+  account(now);
+  hal_Relay(on);
+  if(on)
+  {
+    OnAt=now;
+    Stats.starts++;
+  }
+  else
+  {
+    uint32_t run=(now-OnAt)/1000;
+    if(run>Stats.longest)
+      Stats.longest=run;
+  }
+  Pump.at=now;
+  Pump.source=source;
+  hal_Unlock(lock);
+}
+
+//-------------------------------------------------------------------------------------------
+static void save_Stats(void)                            //nächsten Platz im Ring schreiben
+{
+  PumpStats s;
+  uint8_t lock=hal_Lock();
+  s=Stats;
+  hal_Unlock(lock);
+  s.seq=Stats.seq+1;
+  if(s.seq==0xFF)                                       //0xFF heißt "leer"
+    s.seq=0;
+  s.crc=crc8((const uint8_t *)&s, STATS_CRC_LEN);
+  uint8_t next=(Slot+1)%STATS_SLOTS;
+  SavePending=!hal_EeWrite(EE_STATS+next*sizeof(PumpStats), &s, sizeof(PumpStats));
+  if(SavePending)                                       //Warteschlange voll, nächste Sekunde
+    return;
+  Stats.seq=s.seq;
+  Slot=next;
+  Saved=s.runtime;
+  SavedStarts=s.starts;
+}
+
+//-------------------------------------------------------------------------------------------
+void pump_Task(void)                                    //Task (1s)
+{
+  uint8_t lock=hal_Lock();                              //Zähler teilt sich der Task mit pump_Set()
+  uint32_t now=hal_Millis();                            //im Interrupt
+  account(now);
+  if(now-HourStart>=HOUR_MS)                            //volle Stunde: Tastgrad in 1/100 %
+  {                                                     //= ms / (3600000/10000)
+    HourStart+=HOUR_MS;
+    Pump.dutyHour=HourMs/(HOUR_MS/DUTY_FULL);
+    HourMs=0;
+    if(++Hours==24)
+    {
+      Hours=0;
+      Pump.dutyDay=DayMs/(24*HOUR_MS/DUTY_FULL);
+      DayMs=0;
+      if(Pump.dutyDay>Stats.dutyMax)
+      {
+        Stats.dutyMax=Pump.dutyDay;
+        SavePending=true;                               //neuer Höchstwert muss ins EEPROM
+      }
+    }
+    if(Stats.runtime!=Saved || Stats.starts!=SavedStarts)
+      SavePending=true;                                 //sonst nur bei Änderung schreiben
+  }
+  hal_Unlock(lock);
+  if(SavePending)
+    save_Stats();
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t pump_Runtime(void)                             //für Anzeige und Modbus
+{
+  uint8_t lock=hal_Lock();
+  account(hal_Millis());
+  uint32_t runtime=Stats.runtime;
+  hal_Unlock(lock);
+  return runtime;
+}
+
+//-------------------------------------------------------------------------------------------
+void pump_Stats(PumpStats *stats)                       //starts und longest schreibt pump_Set()
+{                                                       //auch im Interrupt, 32 Bit also gesperrt
+  uint8_t lock=hal_Lock();
+  *stats=Stats;
+  hal_Unlock(lock);
+}
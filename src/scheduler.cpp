@@ -0,0 +1,107 @@
+/*
+Titel     : Kooperativer Scheduler
+--------------------------------------------------------------------------------------
+Funktion  : Tasks werden in Tabellenreihenfolge (= Priorität) ausgeführt, sobald ihr
+            Freigabezeitpunkt erreicht ist. Der nächste Freigabezeitpunkt ergibt sich
+            aus dem vorigen plus Periode, damit driftet der Takt nicht. Liegt ein
+            Task mehr als eine Periode zurück, wird neu aufgesetzt statt nachgeholt.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "scheduler.h"
+
+//---------------------------------- globale Variablen --------------------------------
+uint16_t SchedLoopMax=0;                                //längster Durchlauf von sched_Run() in µs
+volatile uint8_t SchedCurrent=SCHED_IDLE;               //wird im Watchdog-Interrupt gelesen
+
+static Task *TaskTable;                                 //Tasktabelle des Anwenders
+static uint8_t TaskCount;                               //Anzahl der Einträge
+static uint8_t CheckIn;                                 //Bit i: Task i seit sched_Alive() gelaufen
+
+//------------------------------------- Functions -------------------------------------
+void sched_Init(Task *tasks, uint8_t count)             //Tasktabelle übernehmen
+{
+  uint32_t now=hal_Millis();
+  TaskTable=tasks;
+  TaskCount=count;
+  CheckIn=0;
+  SchedLoopMax=0;
+  SchedCurrent=SCHED_IDLE;
+  for(uint8_t i=0; i<count; i++)                        //alle Tasks gleich beim ersten
+  {                                                     //Durchlauf freigeben
+    tasks[i].release=now;
+    tasks[i].runLast=tasks[i].runMax=0;                 //Messwerte wie nach dem Einschalten
+    tasks[i].overruns=0;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static uint16_t sat16(uint32_t value)                   //auf 16 Bit begrenzen
+{
+  return value>0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+//-------------------------------------------------------------------------------------------
+void sched_Run(void)                                    //alle fälligen Tasks einmal ausführen
+{
+  uint32_t loopStart=hal_Micros();
+
+  for(uint8_t i=0; i<TaskCount; i++)
+  {
+    Task *t=&TaskTable[i];
+    uint32_t now=hal_Millis();
+    if((int32_t)(now-t->release) < 0)                   //noch nicht freigegeben?
+      continue;
+
+    uint32_t late=now-t->release;                       //Verspätung gegenüber der Freigabe in ms
+    uint32_t start=hal_Micros();
+    SchedCurrent=i;
+    t->func();                                          //Task ausführen
+    SchedCurrent=SCHED_IDLE;
+    CheckIn|=1<<i;                                      //Task ist zurückgekehrt
+    uint32_t run=hal_Micros()-start;
+
+    t->runLast=sat16(run);
+    if(t->runLast>t->runMax)
+      t->runMax=t->runLast;
+    if(late*1000UL+run > t->deadline*1000UL)            //Termin überschritten?
+      t->overruns++;
+
+    t->release+=t->period;                              //nächste Freigabe im festen Raster
+    now=hal_Millis();
+    if((int32_t)(now-t->release) >= (int32_t)t->period) //mehr als eine Periode im Rückstand?
+    {
+      t->release=now+t->period;                         //ja, dann nicht nachholen, neu aufsetzen
+    }
+  }
+
+  uint16_t loopTime=sat16(hal_Micros()-loopStart);
+  if(loopTime>SchedLoopMax)
+    SchedLoopMax=loopTime;
+}
+
+//-------------------------------------------------------------------------------------------
+uint32_t sched_Idle(void)                               //Zeit bis zur nächsten Freigabe in ms
+{
+  uint32_t now=hal_Millis();
+  uint32_t idle=0xFFFFFFFF;
+  for(uint8_t i=0; i<TaskCount; i++)
+  {
+    int32_t wait=(int32_t)(TaskTable[i].release-now);
+    if(wait<=0)                                         //ein Task ist schon fällig
+      return 0;
+    if((uint32_t)wait<idle)
+      idle=wait;
+  }
+  return idle;
+}
+
+//-------------------------------------------------------------------------------------------
+bool sched_Alive(void)                                  //erst wenn jeder Task einmal zurück-
+{                                                       //gekehrt ist, darf der Watchdog
+  uint8_t all=(uint8_t)((1<<TaskCount)-1);              //zurückgesetzt werden
+  if((CheckIn & all)!=all)
+    return false;
+  CheckIn=0;
+  return true;
+}
@@ -0,0 +1,345 @@
+/*
+Titel     : Zisternensimulator
+--------------------------------------------------------------------------------------
+Funktion  : Zwischen zwei Freigaben des Schedulers ändern sich Zu- und Ablauf nicht,
+            das Modell wird deshalb je Sprung einmal mit konstanten Strömen
+            integriert. Das Regenprofil gilt stundenweise, die Lufttemperatur folgt
+            Jahres- und Tagesgang, das Wasser folgt ihr mit der Zeitkonstante der
+            erdverlegten Zisterne.
+--------------------------------------------------------------------------------------
+*/
+#ifndef ARDUINO
+#include <math.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "crc.h"
+#include "inputs.h"
+#include "scheduler.h"
+#include "sim.h"
+#include "tank.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define SIM_DAY 86400.0                                 //Sekunden je Tag
+#define SIM_STEP_MAX 1000                               //größter Zeitsprung in ms
+#define TEMP_MEAN 9.0                                   //Jahresmittel der Luft in °C
+#define TEMP_YEAR 11.0                                  //Amplitude Jahresgang in °C
+#define TEMP_DAY 4.0                                    //Amplitude Tagesgang in °C
+#define TEMP_COLD 15                                    //kältester Tag im Jahr (15. Januar)
+#define TEMP_TAU (2.0*SIM_DAY)                          //Zeitkonstante Wasser zu Luft in s
+#define TEMP_STEP 60.0                                  //Rechenschritt der Wassertemperatur in s
+#define RAIN_MAX 8760                                   //Stunden im Regenprofil (ein Jahr)
+#define HANG_MAX 60000                                  //ohne Watchdog endet ein Hänger nach 60s
+#define AWAKE_LOOP 150                                  //Wachzeit je loop() mit fälligen Tasks in µs
+#define CUR_ACTIVE 9.0                                  //ATmega328P aktiv, 16MHz/5V, in mA (Datenblatt typ.)
+#define CUR_IDLE 2.5                                    //dto. in SLEEP_MODE_IDLE
+#define CUR_CONV 1.0                                    //DS18B20 während der Wandlung
+#define CUR_STANDBY 0.001                               //DS18B20 in Ruhe
+
+//------------------------------------- Variablen -------------------------------------
+SimStats SimResult;
+
+static SimConfig Config;
+static double Level;                                    //Pegel in mm
+static double Water;                                    //Wassertemperatur in °C
+static double Time;                                     //Simulationszeit in s
+static double TempLast;                                 //letzte Nachführung der Temperatur in s
+static double TempNext;                                 //nächste Nachführung der Temperatur in s
+static bool Spill;                                      //Zisterne läuft gerade über
+static float Rain[RAIN_MAX];                            //Regen in mm/h je Stunde
+static uint32_t RainHours;                              //belegte Einträge in Rain[]
+static double HangAt;                                   //Zeitpunkt des eingestreuten Hängers, 0 = keiner
+static double HangStart;                                //Beginn des laufenden Hängers, <0 = keiner
+static jmp_buf ResetJmp;                                //Rücksprung für den Watchdog-Reset
+static double MbAt;                                     //Zeitpunkt der nächsten Modbus-Anfrage, <0 = keine
+static uint8_t MbFrame[UART_FRAME];                     //diese Anfrage samt CRC
+static uint8_t MbLen;
+
+void setup(void);                                       //aus main.cpp
+void loop(void);
+
+//------------------------------------- Functions -------------------------------------
+static uint32_t next_Random(uint32_t *state)            //xorshift32, reproduzierbar
+{
+  uint32_t x=*state;
+  x^=x<<13;
+  x^=x>>17;
+  x^=x<<5;
+  return *state=x;
+}
+
+//-------------------------------------------------------------------------------------------
+static void make_Rain(void)                             //ein Jahr Schauer und Landregen erzeugen
+{
+  uint32_t state=Config.seed ? Config.seed : 1;
+  uint32_t h=0;
+  memset(Rain, 0, sizeof(Rain));
+  while(h<RAIN_MAX)
+  {
+    double day=fmod(Config.startDay+h/24.0, 365.0);
+    double wet=0.5-0.2*cos(2*M_PI*(day-TEMP_COLD)/365.0);
+    uint32_t dry=next_Random(&state)%(uint32_t)(48/wet);//Pause bis zum nächsten Regen, im Sommer kürzer
+    uint32_t len=1+next_Random(&state)%8;               //Regendauer 1..8h
+    double mm=0.3+(next_Random(&state)%1000)/1000.0*6.0*wet*2;
+    h+=dry;
+    for(uint32_t i=0; i<len && h<RAIN_MAX; i++, h++)
+      Rain[h]=mm;
+  }
+  RainHours=RAIN_MAX;
+}
+
+//-------------------------------------------------------------------------------------------
+static bool load_Rain(const char *name)                 //Regenprofil lesen, eine Zahl (mm/h) je Zeile,
+{                                                       //'#' leitet einen Kommentar ein
+  FILE *f=fopen(name, "r");
+  if(!f)
+    return false;
+  char line[80];
+  RainHours=0;
+  while(RainHours<RAIN_MAX && fgets(line, sizeof(line), f))
+  {
+    char *end;
+    double mm=strtod(line, &end);
+    if(end!=line)
+      Rain[RainHours++]=mm;
+  }
+  fclose(f);
+  return RainHours>0;
+}
+
+//-------------------------------------------------------------------------------------------
+static void next_Request(void)                          //nächste Zeile der Modbus-Anfragen lesen
+{
+  char line[256];
+  MbAt=-1;
+  while(Config.modbus && fgets(line, sizeof(line), Config.modbus))
+  {
+    char *p=line;
+    char *end;
+    double at=strtod(p, &end);
+    if(end==p)                                          //Leerzeile oder Kommentar
+      continue;
+    p=end;
+    MbLen=0;
+    while(MbLen<UART_FRAME-2)
+    {
+      unsigned long b=strtoul(p, &end, 16);
+      if(end==p)
+        break;
+      MbFrame[MbLen++]=(uint8_t)b;
+      p=end;
+    }
+    uint16_t crc=crc16(MbFrame, MbLen);
+    MbFrame[MbLen++]=(uint8_t)crc;
+    MbFrame[MbLen++]=crc>>8;
+    MbAt=at;
+    return;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static uint8_t probe_State(void)                        //Sonden und Skimmer aus dem Pegel
+{
+  static const uint16_t height[6]=
+    { PROBE_LV0, PROBE_LV1, PROBE_LV2, PROBE_LV3, PROBE_LV4, PROBE_SKIM };
+  uint8_t state=0;
+  for(uint8_t i=0; i<6; i++)                            //IN_LV0..IN_LV4, IN_SKIM liegen auf Bit 0..5
+  {
+    if(Level>=height[i])
+      state|=1<<i;
+  }
+  return state;
+}
+
+//-------------------------------------------------------------------------------------------
+static double air_Temp(double t)                        //Lufttemperatur aus Jahres- und Tagesgang
+{
+  double day=Config.startDay+t/SIM_DAY;
+  return TEMP_MEAN-TEMP_YEAR*cos(2*M_PI*(day-TEMP_COLD)/365.0)
+                  -TEMP_DAY*cos(2*M_PI*(day-floor(day)-1.0/6));
+}                                                       //Tagesminimum gegen 4 Uhr
+
+//-------------------------------------------------------------------------------------------
+static void step_Tank(double dt)                        //Modell um dt Sekunden fortschreiben
+{
+  double in=Rain[(uint32_t)(Time/3600)%RainHours]*Config.roof/3600.0;
+  double out=0;                                         //Liter/s
+  bool pump=hal_RelayState();
+  if(pump)
+  {
+    SimResult.pumpTime+=dt;
+    if(Level>TANK_INTAKE)
+      out=Config.pump/3600.0;
+    else
+      SimResult.dryRun+=dt;                             //Pumpe saugt Luft
+  }
+  SimResult.rain+=in*dt;
+  SimResult.pumped+=out*dt;
+  Level+=(in-out)*dt*1000.0/TANK_AREA;
+  if(Level<0)
+    Level=0;
+  if(Level>TANK_DEPTH)                                  //Überlauf
+  {
+    if(!Spill)                                          //neues Ereignis
+      SimResult.overflows++;
+    Spill=true;
+    SimResult.overflow+=(Level-TANK_DEPTH)*TANK_AREA/1000.0;
+    SimResult.overflowTime+=dt;
+    Level=TANK_DEPTH;
+  }
+  else
+  {
+    Spill=false;
+  }
+  if(Level<SimResult.levelMin)
+    SimResult.levelMin=Level;
+  if(Level>SimResult.levelMax)
+    SimResult.levelMax=Level;
+
+  if(Water<0)
+    SimResult.frostTime+=dt;
+  Time+=dt;
+  if(Time>=TempNext)                                    //Wasser ist träge, Temperatur nur
+  {                                                     //einmal je TEMP_STEP nachführen
+    Water+=(air_Temp(Time)-Water)*(Time-TempLast)/TEMP_TAU;
+    SimTempRaw=(int16_t)lround(Water*TEMP_RAW_PER_C);
+    TempLast=Time;
+    TempNext=Time+TEMP_STEP;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+bool sim_Init(const SimConfig *config)
+{
+  Config=*config;
+  if(Config.rain)
+  {
+    if(!load_Rain(Config.rain))
+      return false;
+  }
+  else
+  {
+    make_Rain();
+  }
+  memset(&SimResult, 0, sizeof(SimResult));
+  Level=Config.level;
+  Time=0;
+  Spill=false;
+  TempLast=TempNext=0;
+  HangAt=Config.hang;
+  next_Request();
+  HangStart=-1;
+  Water=TEMP_MEAN-TEMP_YEAR*cos(2*M_PI*(Config.startDay-TEMP_COLD)/365.0);
+  SimResult.levelMin=SimResult.levelMax=Level;
+  SimTempRaw=(int16_t)lround(Water*TEMP_RAW_PER_C);
+  sim_SetInputs(probe_State());                         //Abbild vor setup() bereitstellen
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_Run(uint32_t seconds)                          //Steuerung und Modell im Wechsel
+{
+  volatile double end=Time+seconds;                     //volatile: überleben den longjmp
+  volatile bool pump=false;                             //Einschalten schon in setup() mitzählen
+  volatile double traceNext=Time;
+  if(setjmp(ResetJmp))                                  //Watchdog-Reset
+  {
+    setup();                                            //Steuerung startet neu und entscheidet sofort
+    if(HangStart>=0)
+    {
+      double t=Time-HangStart;
+      if(t>SimResult.recoverTime)
+        SimResult.recoverTime=t;
+      HangStart=-1;
+    }
+  }
+  while(Time<end)
+  {
+    if(MbAt>=0 && Time>=MbAt)                           //Anfrage des Modbus-Masters
+    {
+      printf("Modbus:       %10.3f s  <", Time);
+      for(uint8_t i=0; i<MbLen; i++)
+        printf(" %02X", MbFrame[i]);
+      printf("\n");
+      sim_UartFrame(MbFrame, MbLen);
+      next_Request();
+    }
+    if(HangAt>0 && Time>=HangAt)                        //Hänger einstreuen
+    {
+      SimHang=true;
+      HangAt=0;
+    }
+    SimSleep=false;
+    loop();                                             //fällige Tasks der Steuerung
+    SimResult.steps++;
+    SimAwakeUs+=AWAKE_LOOP;
+    if(hal_RelayState() && !pump)
+      SimResult.pumpStarts++;
+    pump=hal_RelayState();
+
+    uint32_t ms=sched_Idle();                           //bis zur nächsten Freigabe springen
+    if(ms==0)
+      ms=1;
+    if(ms>SIM_STEP_MAX)
+      ms=SIM_STEP_MAX;
+    sim_Advance(ms*1000);                               //Zeitrad läuft dabei weiter
+    if(!SimSleep)                                       //ohne Schlaf wartet die CPU aktiv
+      SimAwakeUs+=ms*1000.0;
+    step_Tank(ms/1000.0);
+    sim_SetInputs(probe_State());
+
+    if(Config.trace && Time>=traceNext)                 //Verlauf je Minute
+    {
+      fprintf(Config.trace, "%.0f;%.1f;%.2f;%d\n", Time, Level, Water, pump);
+      traceNext+=60;
+    }
+  }
+  double total=Time*1e6;                                //Energiebilanz über die ganze Laufzeit
+  double awake=SimAwakeUs<total ? SimAwakeUs : total;
+  double conv=SimConvUs<total ? SimConvUs : total;
+  SimResult.awake=awake/1e6;
+  SimResult.current=total>0 ? (awake*CUR_ACTIVE+(total-awake)*CUR_IDLE
+                              +conv*CUR_CONV+(total-conv)*CUR_STANDBY)/total : 0;
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_Stall(void)                                    //Steuerung hängt in einem Task, Interrupts
+{                                                       //und Modell laufen in 1ms-Schritten weiter
+  HangStart=Time;
+  SimResult.hangs++;
+  for(uint32_t ms=0; ms<HANG_MAX; ms++)                 //endet über sim_Reset()
+  {
+    sim_Advance(1000);
+    step_Tank(0.001);
+    sim_SetInputs(probe_State());
+  }
+  HangStart=-1;                                         //kein Watchdog, Task läuft weiter
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_WdtEvent(bool reset)
+{
+  if(reset)
+  {
+    SimResult.watchdogs++;
+  }
+  else if(HangStart>=0 && Time-HangStart>SimResult.safeTime)
+  {
+    SimResult.safeTime=Time-HangStart;                  //Relais ist jetzt aus
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void sim_Reset(void)
+{
+  longjmp(ResetJmp, 1);
+}
+
+//-------------------------------------------------------------------------------------------
+double sim_Level(void)
+{
+  return Level;
+}
+#endif
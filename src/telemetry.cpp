@@ -0,0 +1,87 @@
+/*
+Titel     : Telemetrie über die serielle Schnittstelle
+--------------------------------------------------------------------------------------
+Funktion  : Siehe telemetry.h. COBS ersetzt jedes 0x00 durch den Abstand zum
+            nächsten; bei weniger als 254 Byte genügt ein einziges Zusatzbyte vorn.
+            Ein Rahmen ist damit höchstens TELE_SIZE+4 Byte lang, bei 115200 Baud
+            also 2ms auf der Leitung und weit unter der Last von 10 Hz.
+--------------------------------------------------------------------------------------
+*/
+#ifdef TELEMETRY
+#include "hal.h"
+#include "crc.h"
+#include "telemetry.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define TELE_RAW (TELE_SIZE+2)                          //Nutzdaten samt CRC
+#define TELE_WIRE (TELE_RAW+2)                          //COBS-Kopfbyte und Endmarke 0x00
+
+//------------------------------------- Variablen -------------------------------------
+uint8_t TeleDropped=0;
+
+static uint8_t Seq=0;                                   //laufende Nummer
+
+//------------------------------------- Functions -------------------------------------
+static uint8_t *put16(uint8_t *p, uint16_t value)       //Little Endian, unabhängig vom Prozessor
+{
+  *p++=(uint8_t)value;
+  *p++=(uint8_t)(value>>8);
+  return p;
+}
+
+//-------------------------------------------------------------------------------------------
+static uint8_t cobs_Encode(const uint8_t *in, uint8_t len, uint8_t *out)
+{                                                       //len < 254, out braucht len+1 Byte
+  uint8_t code=0;                                       //Index des offenen Kopfbytes
+  uint8_t n=1;
+  for(uint8_t i=0; i<len; i++)
+  {
+    if(in[i]==0)
+    {
+      out[code]=n-code;                                 //Abstand zur Null eintragen
+      code=n++;
+    }
+    else
+      out[n++]=in[i];
+  }
+  out[code]=n-code;
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------
+void tele_Init(void)
+{
+  Seq=0;
+  TeleDropped=0;
+  hal_UartInit(115200, false);
+}
+
+//-------------------------------------------------------------------------------------------
+bool tele_Send(const TeleFrame *frame)
+{
+  uint8_t raw[TELE_RAW];
+  uint8_t wire[TELE_WIRE];
+  uint8_t *p=raw;
+  *p++=TELE_VERSION;
+  *p++=Seq++;
+  p=put16(p, (uint16_t)frame->time);
+  p=put16(p, (uint16_t)(frame->time>>16));
+  *p++=frame->inputs;
+  p=put16(p, (uint16_t)frame->tempRaw);
+  *p++=frame->state;
+  p=put16(p, frame->runOn);
+  p=put16(p, frame->loopMax);
+  p=put16(p, frame->overruns);
+  *p++=frame->faults;
+  *p++=frame->reset;
+  *p++=TeleDropped;
+  put16(p, crc16(raw, TELE_SIZE));
+  uint8_t len=cobs_Encode(raw, TELE_RAW, wire);
+  wire[len++]=0x00;                                     //Rahmenende
+  if(hal_UartSend(wire, len))
+    return true;
+  if(TeleDropped!=0xFF)                                 //Empfänger sieht die Lücke auch an
+    TeleDropped++;                                      //der laufenden Nummer
+  return false;
+}
+#endif
@@ -0,0 +1,129 @@
+/*
+Titel     : Zeitrad für Verzögerungen und Zeitüberwachungen
+--------------------------------------------------------------------------------------
+Funktion  : Jedes Fach ist eine doppelt verkettete Liste. Statt eines Rückwärts-
+            zeigers merkt sich jeder Timer die Adresse des Zeigers, der auf ihn
+            zeigt (Fachanfang oder next des Vorgängers), damit ist das Aushängen
+            ohne Suchen möglich. Abgelaufene Timer wandern erst in die Liste Due
+            und werden danach ausgelöst, so dürfen Funktionen andere Timer stellen
+            oder löschen.
+--------------------------------------------------------------------------------------
+*/
+#include "hal.h"
+#include "timer.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define SLOT_MASK (TIMER_SLOTS-1)
+#define SLOT_BITS 6                                     //log2(TIMER_SLOTS)
+
+//------------------------------------- Variablen -------------------------------------
+volatile uint8_t TimerFlags=0;
+
+static Timer *Wheel[TIMER_SLOTS];                       //Fachanfänge
+static Timer *Due;                                      //abgelaufen, noch nicht ausgelöst
+static uint8_t Now;                                     //aktuelles Fach
+
+//------------------------------------- Functions -------------------------------------
+static void link_In(Timer **head, Timer *t)             //am Listenanfang einhängen
+{
+  t->next=*head;
+  if(t->next)
+    t->next->link=&t->next;
+  *head=t;
+  t->link=head;
+}
+
+//-------------------------------------------------------------------------------------------
+static void link_Out(Timer *t)                          //aushängen, Liste egal
+{
+  *t->link=t->next;
+  if(t->next)
+    t->next->link=t->link;
+  t->link=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void timer_Arm(Timer *t, uint32_t ms)
+{
+  if(ms==0)
+    ms=1;
+  uint8_t lock=hal_Lock();
+  if(t->link)                                           //schon gestellt, dann neu stellen
+    link_Out(t);
+  t->rounds=(ms-1)>>SLOT_BITS;
+  link_In(&Wheel[(Now+ms)&SLOT_MASK], t);
+  hal_Unlock(lock);
+}
+
+//-------------------------------------------------------------------------------------------
+void timer_Cancel(Timer *t)
+{
+  uint8_t lock=hal_Lock();
+  if(t->link)
+    link_Out(t);
+  hal_Unlock(lock);
+}
+
+//-------------------------------------------------------------------------------------------
+bool timer_Armed(const Timer *t)                        //Zeiger haben 16 Bit, deshalb
+{                                                       //gesperrt lesen
+  uint8_t lock=hal_Lock();
+  bool armed=t->link!=0;
+  hal_Unlock(lock);
+  return armed;
+}
+
+//-------------------------------------------------------------------------------------------
+uint8_t timer_Flag(uint8_t mask)
+{
+  uint8_t lock=hal_Lock();
+  uint8_t flags=TimerFlags & mask;
+  TimerFlags&=~mask;
+  hal_Unlock(lock);
+  return flags;
+}
+
+//-------------------------------------------------------------------------------------------
+void timer_Tick(void)                                   //im Interrupt, Interrupts gesperrt
+{
+  Now=(Now+1)&SLOT_MASK;
+  Timer *t=Wheel[Now];
+  while(t)                                              //nur die Timer dieses Fachs
+  {
+    Timer *next=t->next;
+    if(t->rounds)
+    {
+      t->rounds--;
+    }
+    else
+    {
+      link_Out(t);
+      link_In(&Due, t);
+    }
+    t=next;
+  }
+  while(Due)                                            //abgelaufene auslösen
+  {
+    t=Due;
+    link_Out(t);
+    if(t->func)
+      t->func();
+    else
+      TimerFlags|=t->flag;
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+void timer_Init(void)                                   //alle Timer aushängen, nach einem echten
+{                                                       //Reset ist das Rad ohnehin leer
+  uint8_t lock=hal_Lock();
+  for(uint8_t i=0; i<TIMER_SLOTS; i++)
+  {
+    while(Wheel[i])
+      link_Out(Wheel[i]);
+  }
+  while(Due)
+    link_Out(Due);
+  TimerFlags=0;
+  hal_Unlock(lock);
+}
@@ -0,0 +1,77 @@
+/*
+Titel     : Test der Zulaufschätzung (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Prüft inflow.cpp: Rate erst aus zwei nacheinander nass gewordenen
+            Sonden, keine Rate und kein Alarm, wenn nur LV0 nass wird, Alarm bei
+            schnellem Anstieg kurz vor dem Überlauf und Rücknahme beim Schalten
+            des Relais.
+            Aufruf: pio test -e native
+--------------------------------------------------------------------------------------
+*/
+#include <unity.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "inputs.h"
+#include "inflow.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define SECOND 1000000UL                                //sim_Advance() rechnet in µs
+#define BELOW_LV3 (IN_LV0|IN_LV1|IN_LV2)
+
+//------------------------------------- Functions -------------------------------------
+void setUp(void)
+{
+  hal_Init();
+  inflow_Init(0);                                       //Zisterne leer, Relais aus
+}
+
+//-------------------------------------------------------------------------------------------
+void tearDown(void)
+{
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_first_probe(void)                      //LV0 nass: keine Sonde darunter,
+{                                                       //also weder Rate noch Alarm
+  sim_Advance(SECOND);
+  inflow_Update(IN_LV0, false);
+  TEST_ASSERT_EQUAL_UINT32(0, InflowRate);
+  TEST_ASSERT_FALSE(inflow_Alarm());
+  sim_Advance(3600*SECOND);
+  TEST_ASSERT_FALSE(inflow_Alarm());
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_rate(void)                             //LV0 -> LV1: 150mm in 150s = 3600mm/h
+{
+  inflow_Update(IN_LV0, false);
+  sim_Advance(150*SECOND);
+  inflow_Update(IN_LV0|IN_LV1, false);
+  TEST_ASSERT_EQUAL_UINT32(3600, InflowRate);
+  TEST_ASSERT_EQUAL_UINT16(3600, inflow_Liters());
+  TEST_ASSERT_FALSE(inflow_Alarm());                    //Überlauf erst in über 10 min
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_alarm(void)                            //LV3 -> LV4 in 15s: Überlauf in 15s,
+{                                                       //Alarm sofort, Relais nimmt ihn zurück
+  inflow_Init(BELOW_LV3);
+  inflow_Update(BELOW_LV3|IN_LV3, false);
+  sim_Advance(15*SECOND);
+  inflow_Update(BELOW_LV3|IN_LV3|IN_LV4, false);
+  TEST_ASSERT_EQUAL_UINT32(36000, InflowRate);
+  TEST_ASSERT_TRUE(inflow_Alarm());
+  inflow_Update(BELOW_LV3|IN_LV3|IN_LV4, true);
+  TEST_ASSERT_FALSE(inflow_Alarm());
+  TEST_ASSERT_EQUAL_UINT32(36000, InflowRate);          //letzter Messwert bleibt lesbar
+}
+
+//-------------------------------------------------------------------------------------------
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_first_probe);
+  RUN_TEST(test_rate);
+  RUN_TEST(test_alarm);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+/*
+Titel     : Test des Neustarts (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Nach einem Watchdog-Reset ruft der Simulator setup() erneut auf, ohne
+            dass die Variablen wie auf dem Nano neu belegt werden. setup() muss
+            deshalb selbst den Zustand wie nach dem Einschalten herstellen:
+            Temperaturerfassung, Frost, Notbetrieb, Bildspeicher und Sonderzeichen.
+            Aufruf: pio test -e native
+--------------------------------------------------------------------------------------
+*/
+#include <unity.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "eventlog.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define TEMP_INIT 0                                     //wie in main.cpp
+#define GLYPHS 8
+
+//------------------------------------- Variablen -------------------------------------
+extern bool Frost;                                      //aus main.cpp
+extern bool SensorFault;
+extern uint8_t TempState;
+extern int16_t TempRaw;
+extern uint8_t GlyphsLoaded;
+
+void setup(void);
+void loop(void);
+
+//------------------------------------- Functions -------------------------------------
+static void run(uint32_t ms)                            //Steuerung ms Millisekunden laufen lassen
+{
+  while(ms--)
+  {
+    loop();
+    sim_Advance(1000);
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void check_Boot(void)                            //Zustand direkt nach setup()
+{
+  TEST_ASSERT_FALSE(Frost);
+  TEST_ASSERT_FALSE(SensorFault);
+  TEST_ASSERT_EQUAL_UINT8(TEMP_INIT, TempState);
+  TEST_ASSERT_EQUAL_INT16(TEMP_NONE, TempRaw);
+  TEST_ASSERT_EQUAL_UINT8(GLYPHS, GlyphsLoaded);
+  TEST_ASSERT_EQUAL_UINT8(0, LogLost);
+  TEST_ASSERT_EQUAL_STRING(" ZISTERNE  V1.1 ", sim_LcdLine(0));
+  TEST_ASSERT_EQUAL_STRING("c2025 by P.Lampe", sim_LcdLine(1));
+}
+
+//-------------------------------------------------------------------------------------------
+void setUp(void)                                        //neuer Chip, Sonden trocken, 20°C
+{
+  sim_EeErase();
+  SimEeFree=0xFF;
+  SimTempRaw=20*TEMP_RAW_PER_C;
+  sim_SetInputs(0);
+}
+
+//-------------------------------------------------------------------------------------------
+void tearDown(void)
+{
+  SimTempRaw=20*TEMP_RAW_PER_C;
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_reset_after_frost(void)                //Frost und Messwert vergessen
+{
+  SimTempRaw=-5*TEMP_RAW_PER_C;
+  setup();
+  run(15000);                                           //Intro vorbei, eine Messung da
+  TEST_ASSERT_TRUE(Frost);
+  TEST_ASSERT_NOT_EQUAL(TEMP_NONE, TempRaw);
+  SimTempRaw=20*TEMP_RAW_PER_C;
+  setup();                                              //wie sim_Reset()
+  check_Boot();
+  run(15000);                                           //neue Messung: kein Frost
+  TEST_ASSERT_FALSE(Frost);
+  TEST_ASSERT_EQUAL_INT16(20*TEMP_RAW_PER_C, TempRaw);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_reset_after_fault(void)                //Notbetrieb endet mit dem Reset
+{
+  SimTempRaw=TEMP_NONE;
+  setup();
+  run(15000);
+  TEST_ASSERT_TRUE(SensorFault);
+  SimTempRaw=20*TEMP_RAW_PER_C;
+  setup();
+  check_Boot();
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_reset_during_glyphs(void)              //Reset mitten im Laden der Sonderzeichen
+{
+  setup();
+  run(3000);                                            //Intro läuft gerade ab
+  GlyphsLoaded=3;
+  setup();
+  check_Boot();
+  run(3500);                                            //Hauptbildschirm mit Temperatur,
+  TEST_ASSERT_EQUAL_UINT8(GLYPHS, GlyphsLoaded);        //ohne Reste des Startbildschirms
+  TEST_ASSERT_EQUAL_STRING("On <-- S --> Off", sim_LcdLine(1));
+  TEST_ASSERT_EQUAL_UINT8('*', sim_LcdLine(0)[9]);
+}
+
+//-------------------------------------------------------------------------------------------
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_reset_after_frost);
+  RUN_TEST(test_reset_after_fault);
+  RUN_TEST(test_reset_during_glyphs);
+  return UNITY_END();
+}
@@ -0,0 +1,323 @@
+/*
+Titel     : Test der EEPROM-Ringe (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Prüft die Wiederherstellung nach einem Neustart für Einstellungen
+            (config.cpp), Pumpenstatistik (pump.cpp) und Ereignisprotokoll
+            (eventlog.cpp): angefangener Eintrag, Überlauf der Folgenummer bzw.
+            des Umlaufbits und volle Schreibwarteschlange (SimEeFree).
+            Aufruf: pio test -e native
+--------------------------------------------------------------------------------------
+*/
+#include <unity.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "eeprom_map.h"
+#include "crc.h"
+#include "config.h"
+#include "pump.h"
+#include "eventlog.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define CFG_ADDR(slot) (EE_CONFIG+(slot)*sizeof(Config))
+#define STATS_ADDR(slot) (EE_STATS+(slot)*sizeof(PumpStats))
+#define LOG_ADDR(slot) (EE_LOG+(slot)*sizeof(LogRecord))
+#define SECOND 1000000UL                                //sim_Advance() rechnet in µs
+
+//------------------------------------- Functions -------------------------------------
+static void corrupt(uint16_t addr)                      //ein Byte kippen wie ein abgebrochener
+{                                                       //Schreibvorgang
+  uint8_t b;
+  hal_EeRead(addr, &b, 1);
+  b^=0x5A;
+  hal_EeWrite(addr, &b, 1);
+}
+
+//-------------------------------------------------------------------------------------------
+static void pump_Hour(void)                             //ein Start mit 60s Lauf, dann bis zur
+{                                                       //vollen Stunde und pump_Task
+  pump_Set(true, PUMP_LEVEL);
+  sim_Advance(60*SECOND);
+  pump_Set(false, PUMP_RUNON);
+  sim_Advance(3540*SECOND);
+  pump_Task();
+}
+
+//-------------------------------------------------------------------------------------------
+void setUp(void)                                        //neuer Chip, Warteschlange frei
+{
+  sim_EeErase();
+  SimEeFree=0xFF;
+  hal_Init();
+}
+
+//-------------------------------------------------------------------------------------------
+void tearDown(void)
+{
+  SimEeFree=0xFF;
+}
+
+//------------------------------------ Einstellungen ----------------------------------
+static void test_cfg_empty(void)
+{
+  Config c;
+  TEST_ASSERT_FALSE(cfg_Load(&c));
+  TEST_ASSERT_EQUAL_UINT8(SOMMER, c.season);
+  TEST_ASSERT_EQUAL_UINT8(ONTIME, c.onTime);
+  TEST_ASSERT_EQUAL_INT8(FROSTTEMP, c.frostTemp);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cfg_torn(void)                         //angefangener Eintrag: der davor gilt
+{
+  Config c, d;
+  cfg_Load(&c);
+  c.season=WINTER;
+  TEST_ASSERT_TRUE(cfg_Save(&c));                       //Platz 0
+  c.onTime=90;
+  TEST_ASSERT_TRUE(cfg_Save(&c));                       //Platz 1
+  corrupt(CFG_ADDR(1)+5);
+  TEST_ASSERT_TRUE(cfg_Load(&d));
+  TEST_ASSERT_EQUAL_UINT8(WINTER, d.season);
+  TEST_ASSERT_EQUAL_UINT8(ONTIME, d.onTime);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cfg_seq_wrap(void)                     //300 Änderungen: Folgenummer läuft über,
+{                                                       //Ring neun Mal herum
+  Config c, d;
+  cfg_Load(&c);
+  for(uint16_t i=0; i<300; i++)
+  {
+    c.onTime=i%250+1;
+    TEST_ASSERT_TRUE(cfg_Save(&c));
+  }
+  TEST_ASSERT_TRUE(cfg_Load(&d));
+  TEST_ASSERT_EQUAL_UINT8(299%250+1, d.onTime);
+  TEST_ASSERT_EQUAL_UINT8(300%256, d.seq);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cfg_queue_full(void)                   //abgewiesen, dann nachgeholt
+{
+  Config c, d;
+  cfg_Load(&c);
+  c.season=WINTER;
+  SimEeFree=0;
+  TEST_ASSERT_FALSE(cfg_Save(&c));
+  cfg_Flush();                                          //noch kein Platz
+  SimEeFree=0xFF;
+  uint8_t b;
+  hal_EeRead(CFG_ADDR(0), &b, 1);
+  TEST_ASSERT_EQUAL_UINT8(0xFF, b);                     //EEPROM hat noch den alten Stand
+  cfg_Flush();
+  cfg_Load(&d);
+  TEST_ASSERT_EQUAL_UINT8(WINTER, d.season);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cfg_queue_full_reset(void)             //Neustart verwirft die abgewiesene
+{                                                       //Änderung, wie auf dem Nano
+  Config c, d;
+  cfg_Load(&c);
+  c.season=WINTER;
+  SimEeFree=0;
+  TEST_ASSERT_FALSE(cfg_Save(&c));
+  SimEeFree=0xFF;
+  cfg_Load(&d);                                         //wie setup() nach dem Reset
+  cfg_Flush();
+  cfg_Load(&d);
+  TEST_ASSERT_EQUAL_UINT8(SOMMER, d.season);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cfg_queue_full_reverted(void)          //zurückgenommene Änderung wird nicht
+{                                                       //nachgeholt
+  Config c, d;
+  cfg_Load(&c);
+  c.season=WINTER;
+  TEST_ASSERT_TRUE(cfg_Save(&c));
+  uint8_t seq=c.seq;
+  SimEeFree=0;
+  c.season=SOMMER;
+  TEST_ASSERT_FALSE(cfg_Save(&c));
+  c.season=WINTER;
+  TEST_ASSERT_TRUE(cfg_Save(&c));                       //wie gespeichert: nichts zu tun
+  SimEeFree=0xFF;
+  cfg_Flush();
+  cfg_Load(&d);
+  TEST_ASSERT_EQUAL_UINT8(WINTER, d.season);
+  TEST_ASSERT_EQUAL_UINT8(seq, d.seq);
+}
+
+//------------------------------------ Pumpenstatistik --------------------------------
+static void test_pump_reload(void)                      //20 Stunden, Ring (15) läuft über
+{
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(0, Stats.starts);
+  for(uint8_t h=0; h<20; h++)
+    pump_Hour();
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(20, Stats.starts);
+  TEST_ASSERT_EQUAL_UINT32(20*60, Stats.runtime);
+  TEST_ASSERT_EQUAL_UINT32(60, Stats.longest);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_pump_duty_max(void)                    //neuer Tageshöchstwert wird gespeichert,
+{                                                       //auch ohne Lauf in der letzten Stunde
+  pump_Init();
+  pump_Hour();                                          //60s Lauf am Tag = 6/10000
+  for(uint8_t h=1; h<24; h++)
+  {
+    sim_Advance(3600*SECOND);
+    pump_Task();
+  }
+  TEST_ASSERT_EQUAL_UINT16(6, Stats.dutyMax);
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT16(6, Stats.dutyMax);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_pump_torn(void)                        //jüngster Eintrag angefangen
+{
+  pump_Init();
+  for(uint8_t h=0; h<3; h++)                            //Plätze 0, 1, 2
+    pump_Hour();
+  corrupt(STATS_ADDR(2));
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(2, Stats.starts);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_pump_seq_wrap(void)                    //Folgenummern 242..254, 0, 1 (0xFF wird
+{                                                       //übersprungen), der jüngste auf Platz 9
+  for(uint8_t i=0; i<STATS_SLOTS; i++)
+  {
+    uint8_t age=(9+STATS_SLOTS-i)%STATS_SLOTS;          //0 = jüngster
+    PumpStats s={ 100u-age, 0, 0, 0, 0, 0 };
+    s.seq=age<=1 ? 1-age : 256-age;
+    s.crc=crc8((const uint8_t *)&s, sizeof(PumpStats)-1);
+    hal_EeWrite(STATS_ADDR(i), &s, sizeof(PumpStats));
+  }
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(100, Stats.starts);
+  pump_Hour();                                          //nächster Eintrag: Platz 10, Folgenummer 2
+  PumpStats s;
+  hal_EeRead(STATS_ADDR(10), &s, sizeof(PumpStats));
+  TEST_ASSERT_EQUAL_UINT8(2, s.seq);
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(101, Stats.starts);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_pump_queue_full(void)                  //abgewiesen, in der nächsten Sekunde
+{                                                       //nachgeholt
+  pump_Init();
+  SimEeFree=0;
+  pump_Hour();
+  SimEeFree=0xFF;
+  PumpStats s;
+  hal_EeRead(STATS_ADDR(0), &s, sizeof(PumpStats));
+  TEST_ASSERT_EQUAL_UINT8(0xFF, s.seq);                 //noch leer
+  sim_Advance(SECOND);
+  pump_Task();
+  pump_Init();
+  TEST_ASSERT_EQUAL_UINT32(1, Stats.starts);
+}
+
+//---------------------------------- Ereignisprotokoll --------------------------------
+static void test_log_order(void)
+{
+  LogRecord rec;
+  log_Init();
+  TEST_ASSERT_FALSE(log_Read(0, &rec));
+  for(uint8_t i=0; i<10; i++)
+    log_Event(LOG_PROBES, i);
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(LOG_PROBES, rec.code);
+  TEST_ASSERT_EQUAL_UINT8(9, rec.data);
+  TEST_ASSERT_TRUE(log_Read(9, &rec));
+  TEST_ASSERT_EQUAL_UINT8(0, rec.data);
+  TEST_ASSERT_FALSE(log_Read(10, &rec));
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_log_wrap_reboot(void)                  //anderthalb Umläufe, dann Neustart:
+{                                                       //Position über das Umlaufbit finden
+  LogRecord rec;
+  log_Init();
+  for(uint8_t i=0; i<200; i++)
+    log_Event(LOG_PROBES, i);
+  log_Init();
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(199, rec.data);
+  TEST_ASSERT_TRUE(log_Read(LOG_SLOTS-1, &rec));
+  TEST_ASSERT_EQUAL_UINT8(200-LOG_SLOTS, rec.data);
+  TEST_ASSERT_FALSE(log_Read(LOG_SLOTS, &rec));
+  log_Event(LOG_SKIM, 0);
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(LOG_SKIM, rec.code);
+  TEST_ASSERT_TRUE(log_Read(1, &rec));
+  TEST_ASSERT_EQUAL_UINT8(199, rec.data);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_log_torn(void)                         //Bytes 1..3 geschrieben, Byte 0 nicht:
+{                                                       //zählt noch zum alten Umlauf
+  LogRecord rec;
+  log_Init();
+  for(uint8_t i=0; i<5; i++)
+    log_Event(LOG_PROBES, i);
+  static const uint8_t rest[3]={ 0x12, 0x34, 0x56 };
+  hal_EeWrite(LOG_ADDR(5)+1, rest, 3);
+  log_Init();
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(4, rec.data);
+  log_Event(LOG_SKIM, 7);                               //überschreibt den angefangenen Platz
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(7, rec.data);
+  TEST_ASSERT_TRUE(log_Read(1, &rec));
+  TEST_ASSERT_EQUAL_UINT8(4, rec.data);
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_log_queue_full(void)                   //3 freie Bytes reichen nicht: nichts
+{                                                       //schreiben, im RAM behalten
+  LogRecord rec;
+  log_Init();
+  log_Event(LOG_PROBES, 1);
+  SimEeFree=sizeof(LogRecord)-1;
+  uint8_t lost=LogLost;
+  log_Event(LOG_PROBES, 2);
+  uint8_t raw[sizeof(LogRecord)];
+  hal_EeRead(LOG_ADDR(1), raw, sizeof(raw));
+  for(uint8_t i=0; i<sizeof(raw); i++)
+    TEST_ASSERT_EQUAL_UINT8(0xFF, raw[i]);
+  SimEeFree=0xFF;
+  log_Flush();
+  TEST_ASSERT_TRUE(log_Read(0, &rec));
+  TEST_ASSERT_EQUAL_UINT8(2, rec.data);
+  TEST_ASSERT_EQUAL_UINT8(lost, LogLost);
+}
+
+//-------------------------------------------------------------------------------------------
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_cfg_empty);
+  RUN_TEST(test_cfg_torn);
+  RUN_TEST(test_cfg_seq_wrap);
+  RUN_TEST(test_cfg_queue_full);
+  RUN_TEST(test_cfg_queue_full_reverted);
+  RUN_TEST(test_cfg_queue_full_reset);
+  RUN_TEST(test_pump_reload);
+  RUN_TEST(test_pump_duty_max);
+  RUN_TEST(test_pump_torn);
+  RUN_TEST(test_pump_seq_wrap);
+  RUN_TEST(test_pump_queue_full);
+  RUN_TEST(test_log_order);
+  RUN_TEST(test_log_wrap_reboot);
+  RUN_TEST(test_log_torn);
+  RUN_TEST(test_log_queue_full);
+  return UNITY_END();
+}
@@ -0,0 +1,154 @@
+/*
+Titel     : Test des Zeitrads (Umgebung "native")
+--------------------------------------------------------------------------------------
+Funktion  : Prüft die Ablaufrechnung von timer.cpp: Fach = (Now+ms) mod
+            TIMER_SLOTS, dazu (ms-1)/TIMER_SLOTS volle Umläufe. Ein Timer muss
+            genau beim ms-ten Takt nach dem Stellen ablaufen, unabhängig davon,
+            wo das Rad gerade steht und wer sich sonst im Fach befindet.
+            Aufruf: pio test -e native
+--------------------------------------------------------------------------------------
+*/
+#include <unity.h>
+#include "hal.h"
+#include "timer.h"
+
+//--------------------------------------- Defines -------------------------------------
+#define TF_A 0x01
+#define TF_B 0x02
+#define TF_C 0x04
+#define LIMIT 100000UL                                  //Abbruch, falls ein Timer nie abläuft
+
+//------------------------------------- Variablen -------------------------------------
+static uint16_t Calls;                                  //Aufrufe von on_Expire
+static void on_Expire(void);
+static Timer Periodic=TIMER_CALL(on_Expire);
+
+//------------------------------------- Functions -------------------------------------
+static void on_Expire(void)                             //stellt sich selbst neu, wie eine Periode
+{
+  Calls++;
+  timer_Arm(&Periodic, 10);
+}
+
+//-------------------------------------------------------------------------------------------
+static uint32_t ticks_Until(uint8_t flag)               //Takte bis zum Flag
+{
+  for(uint32_t n=1; n<=LIMIT; n++)
+  {
+    timer_Tick();
+    if(timer_Flag(flag))
+      return n;
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+void setUp(void)
+{
+  timer_Init();
+  Calls=0;
+}
+
+//-------------------------------------------------------------------------------------------
+void tearDown(void)
+{
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_expiry_exact(void)                     //Grenzen von Fach und Umlauf
+{
+  static const uint32_t ms[]={ 1, 2, 63, 64, 65, 127, 128, 129, 1000, 60000 };
+  for(uint8_t i=0; i<sizeof(ms)/sizeof(ms[0]); i++)
+  {
+    Timer t=TIMER_FLAG(TF_A);
+    timer_Arm(&t, ms[i]);
+    TEST_ASSERT_TRUE(timer_Armed(&t));
+    TEST_ASSERT_EQUAL_UINT32(ms[i], ticks_Until(TF_A));
+    TEST_ASSERT_FALSE(timer_Armed(&t));
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_expiry_any_position(void)              //Rad vorher beliebig weit gedreht
+{
+  for(uint16_t skip=0; skip<2*TIMER_SLOTS+3; skip+=7)
+  {
+    for(uint16_t i=0; i<skip; i++)
+      timer_Tick();
+    Timer t=TIMER_FLAG(TF_A);
+    timer_Arm(&t, 100);
+    TEST_ASSERT_EQUAL_UINT32(100, ticks_Until(TF_A));
+  }
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_zero_is_one_ms(void)
+{
+  Timer t=TIMER_FLAG(TF_A);
+  timer_Arm(&t, 0);
+  TEST_ASSERT_EQUAL_UINT32(1, ticks_Until(TF_A));
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_same_slot(void)                        //gleiches Fach, verschiedene Umläufe
+{
+  Timer a=TIMER_FLAG(TF_A);
+  Timer b=TIMER_FLAG(TF_B);
+  Timer c=TIMER_FLAG(TF_C);
+  timer_Arm(&c, 5+2*TIMER_SLOTS);
+  timer_Arm(&a, 5);
+  timer_Arm(&b, 5+TIMER_SLOTS);
+  TEST_ASSERT_EQUAL_UINT32(5, ticks_Until(TF_A));
+  TEST_ASSERT_TRUE(timer_Armed(&b));
+  TEST_ASSERT_EQUAL_UINT32(TIMER_SLOTS, ticks_Until(TF_B));
+  TEST_ASSERT_TRUE(timer_Armed(&c));
+  TEST_ASSERT_EQUAL_UINT32(TIMER_SLOTS, ticks_Until(TF_C));
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_rearm_restarts(void)                   //neu stellen zählt ab jetzt
+{
+  Timer t=TIMER_FLAG(TF_A);
+  timer_Arm(&t, 100);
+  for(uint8_t i=0; i<50; i++)
+    timer_Tick();
+  timer_Arm(&t, 100);
+  TEST_ASSERT_EQUAL_UINT32(100, ticks_Until(TF_A));
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_cancel(void)
+{
+  Timer t=TIMER_FLAG(TF_A);
+  timer_Arm(&t, 30);
+  timer_Cancel(&t);
+  TEST_ASSERT_FALSE(timer_Armed(&t));
+  for(uint16_t i=0; i<300; i++)
+    timer_Tick();
+  TEST_ASSERT_FALSE(timer_Flag(TF_A));
+  timer_Cancel(&t);                                     //zweimal löschen schadet nicht
+}
+
+//-------------------------------------------------------------------------------------------
+static void test_callback_rearms(void)                  //Funktion stellt sich im Ablauf neu
+{
+  timer_Arm(&Periodic, 10);
+  for(uint16_t i=0; i<1000; i++)
+    timer_Tick();
+  TEST_ASSERT_EQUAL_UINT16(100, Calls);
+  timer_Cancel(&Periodic);
+}
+
+//-------------------------------------------------------------------------------------------
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_expiry_exact);
+  RUN_TEST(test_expiry_any_position);
+  RUN_TEST(test_zero_is_one_ms);
+  RUN_TEST(test_same_slot);
+  RUN_TEST(test_rearm_restarts);
+  RUN_TEST(test_cancel);
+  RUN_TEST(test_callback_rearms);
+  return UNITY_END();
+}
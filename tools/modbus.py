@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Einfacher Modbus-RTU-Master zum Testen der Steuerung (-DMODBUS).
+
+Aufruf: modbus.py Port Befehl [Argumente]
+  modbus.py /dev/ttyUSB0 status            alle Input und Holding Register anzeigen
+  modbus.py /dev/ttyUSB0 input 0 17        Input Register ab 0, 17 Stück
+  modbus.py /dev/ttyUSB0 holding 0 6       Holding Register ab 0, 6 Stück
+  modbus.py /dev/ttyUSB0 write 1 90        Holding Register 1 (Nachlaufzeit) = 90
+  modbus.py /dev/ttyUSB0 log 32            die jüngsten 32 Ereignisse, ältestes zuerst
+  modbus.py - write 5 1                    Anfrage nur als Hex ausgeben (für "program -m")
+Braucht pyserial. 19200 Baud, 8E1, Slave-Adresse 1 (siehe include/modbus.h).
+"""
+import struct
+import sys
+
+ADDR = 1
+BAUD = 19200
+REGS_MAX = 16                                  # MB_REGS_MAX in include/modbus.h
+INPUTS = ["Eingänge", "Level", "Temperatur/0.1°C", "Rohwert/128", "Relais",
+          "Nachlauf/0.1s", "Frost", "Fehler", "Starts", "Laufzeit/h",
+          "Reset", "Watchdogs", "CRC-Fehler", "längster Lauf/s",
+          "Tastgrad Std/0.01%", "Tastgrad Tag/0.01%", "Tastgrad max/0.01%",
+          "Zulauf/l/h"]
+HOLDING = ["Jahreszeit", "Nachlaufzeit/s", "Frostgrenze/°C", "Level Sommer",
+           "Level Winter", "Pumpe", "Protokollalter"]
+LOG_REG = 18                                   # MB_IR_LOG in include/modbus.h
+LOG_AGE = 6                                    # MB_HR_LOGAGE
+LOG_WINDOW = 8                                 # MB_LOG_WINDOW
+LOG_SLOTS = 128                                # LOG_SLOTS in include/eventlog.h
+EVENTS = ["?", "Start", "Pumpe ein", "Pumpe aus", "Sonden", "Skimmer", "Frost",
+          "Frost vorbei", "Jahreszeit", "Sensor fehlt", "Sensor ok", "Watchdog"]
+EXCEPTIONS = {1: "Funktion", 2: "Register", 3: "Wert", 4: "nicht möglich"}
+
+
+def crc16(data):
+    """CRC-16 (Modbus), wie crc16() in src/crc.cpp."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def frame(pdu):
+    """Adresse und CRC um die Anfrage legen."""
+    body = bytes([ADDR]) + pdu
+    return body + struct.pack("<H", crc16(body))
+
+
+def transact(port, pdu, answer):
+    """Anfrage senden, Antwort mit answer Byte Nutzdaten lesen und prüfen."""
+    port.reset_input_buffer()
+    port.write(frame(pdu))
+    head = port.read(2)
+    if len(head) < 2:
+        raise IOError("keine Antwort")
+    if head[1] & 0x80:                         # Ausnahme: Code und CRC
+        rest = port.read(3)
+        code = rest[0] if rest else 0
+        raise IOError("Ausnahme %d (%s)" % (code, EXCEPTIONS.get(code, "?")))
+    rest = port.read(answer + 2)
+    data = head + rest
+    if len(rest) < answer + 2 or crc16(data[:-2]) != struct.unpack("<H", data[-2:])[0]:
+        raise IOError("Antwort gestört")
+    return data[2:-2]
+
+
+def read(port, fn, start, count):
+    data = transact(port, struct.pack(">BHH", fn, start, count), 1 + 2 * count)
+    return list(struct.unpack(">%dH" % count, data[1:]))
+
+
+def write(port, reg, value):
+    transact(port, struct.pack(">BHH", 6, reg, value & 0xFFFF), 4)
+
+
+def read_log(port, count):
+    """Die jüngsten count Einträge fensterweise lesen, jüngster zuerst."""
+    records = []
+    for age in range(0, min(count, LOG_SLOTS), LOG_WINDOW):
+        write(port, LOG_AGE, age)
+        regs = read(port, 4, LOG_REG, 2 * LOG_WINDOW)
+        for i in range(LOG_WINDOW):
+            head, delta = regs[2 * i], regs[2 * i + 1]
+            if head == 0 or len(records) == count:
+                return records
+            records.append((head >> 8, head & 0xFF, delta))
+    return records
+
+
+def signed(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    name, cmd, args = sys.argv[1], sys.argv[2], [int(a, 0) for a in sys.argv[3:]]
+    pdu = {"input": lambda: struct.pack(">BHH", 4, *args),
+           "holding": lambda: struct.pack(">BHH", 3, *args),
+           "write": lambda: struct.pack(">BHH", 6, args[0], args[1] & 0xFFFF)}
+    if name == "-":                            # nur die Anfrage ohne CRC ausgeben
+        print("0 " + " ".join("%02X" % b for b in bytes([ADDR]) + pdu[cmd]()))
+        return 0
+    import serial
+    port = serial.Serial(name, BAUD, parity=serial.PARITY_EVEN, timeout=0.5)
+    try:
+        if cmd == "status":
+            for names, fn in ((INPUTS, 4), (HOLDING, 3)):
+                for start in range(0, len(names), REGS_MAX):
+                    count = min(REGS_MAX, len(names) - start)
+                    for i, v in enumerate(read(port, fn, start, count)):
+                        print("%-18s %6d" % (names[start + i], signed(v)))
+        elif cmd in ("input", "holding"):
+            fn = 4 if cmd == "input" else 3
+            for i, v in enumerate(read(port, fn, args[0], args[1])):
+                print("%3d %6d" % (args[0] + i, v))
+        elif cmd == "write":
+            write(port, args[0], args[1])
+        elif cmd == "log":
+            records = read_log(port, args[0] if args else LOG_SLOTS)
+            t = sum(r[2] for r in records[:-1])    # Sekunden vor dem jüngsten Eintrag
+            for i in range(len(records) - 1, -1, -1):
+                code, data, _ = records[i]
+                name = EVENTS[code] if code < len(EVENTS) else "?"
+                print("%8.2f h  %-13s %3d" % (-t / 3600.0, name, data))
+                if i > 0:
+                    t -= records[i - 1][2]
+        else:
+            print(__doc__)
+            return 2
+    except IOError as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Dekodiert den Telemetriestrom der Steuerung (-DTELEMETRY) nach CSV.
+
+Aufruf: telemetry.py [Quelle] [Baudrate, Vorgabe 115200]
+Quelle ist eine Datei (z.B. von "program -u") oder eine serielle Schnittstelle
+(/dev/ttyUSB0, COM9; braucht pyserial). Ohne Quelle wird stdin gelesen.
+Eine Zeile je Rahmen nach stdout, gestörte Rahmen werden auf stderr gezählt.
+Aufbau der Rahmen siehe include/telemetry.h.
+"""
+import struct
+import sys
+
+VERSION = 1
+PAYLOAD = struct.Struct("<BBIBhBHHHBBB")       # TELE_SIZE = 19 Byte
+TEMP_NONE = -7040
+FIELDS = ["seq", "time_s", "lv0", "lv1", "lv2", "lv3", "lv4", "skim", "on", "off",
+          "temp_c", "relay", "season", "frost", "runon_s", "loop_max_us",
+          "overruns", "sensor_fault", "lcd_error", "log_lost",
+          "reset", "dropped"]
+RESET = ["power", "extern", "brownout", "watchdog"]
+
+
+def crc16(data):
+    """CRC-16 (Modbus), wie crc16() in src/crc.cpp."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_decode(data):
+    """COBS-Block ohne Endmarke zurückwandeln, None bei Fehler."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode(frame):
+    """Rahmen (ohne 0x00) in eine CSV-Zeile wandeln, None bei Fehler."""
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) != PAYLOAD.size + 2:
+        return None
+    body, crc = raw[:-2], raw[-2] | raw[-1] << 8
+    if crc16(body) != crc:
+        return None
+    (version, seq, time, inputs, temp, state, runon, loop_max, overruns,
+     faults, reset, dropped) = PAYLOAD.unpack(body)
+    if version != VERSION:
+        return None
+    row = [seq, "%.3f" % (time / 1000.0)]
+    row += [inputs >> i & 1 for i in range(8)]
+    row.append("" if temp == TEMP_NONE else "%.2f" % (temp / 128.0))
+    row += [state & 1, "S" if state & 2 else "W", state >> 2 & 1, "%.1f" % (runon / 10.0),
+            loop_max, overruns]
+    row += [faults >> i & 1 for i in (0, 2, 3)]   # Bit 1 frei
+    row += [RESET[reset] if reset < len(RESET) else reset, dropped]
+    return ";".join(str(v) for v in row)
+
+
+def open_source(argv):
+    """Datei, serielle Schnittstelle oder stdin als Bytestrom öffnen."""
+    if len(argv) < 2 or argv[1] == "-":
+        return sys.stdin.buffer
+    name = argv[1]
+    if name.startswith("/dev/") or name.upper().startswith("COM"):
+        import serial
+        baud = int(argv[2]) if len(argv) > 2 else 115200
+        return serial.Serial(name, baud, timeout=1)
+    return open(name, "rb")
+
+
+def main():
+    if len(sys.argv) > 1 and sys.argv[1] in ("-h", "--help"):
+        print(__doc__)
+        return 0
+    src = open_source(sys.argv)
+    print(";".join(FIELDS))
+    buf = bytearray()
+    good = bad = 0
+    synced = False                             # erster Rahmen kann angeschnitten sein
+    try:
+        while True:
+            chunk = src.read(256)
+            if not chunk:
+                if hasattr(src, "in_waiting"):  # serielle Schnittstelle: weiter warten
+                    continue
+                break
+            buf += chunk
+            while True:
+                end = buf.find(0)
+                if end < 0:
+                    break
+                frame, buf = bytes(buf[:end]), buf[end + 1:]
+                line = decode(frame) if frame else None
+                if line:
+                    print(line, flush=hasattr(src, "in_waiting"))
+                    good += 1
+                elif synced:
+                    bad += 1
+                synced = True
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write("%d Rahmen, %d gestört\n" % (good, bad))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())